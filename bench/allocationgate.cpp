@@ -0,0 +1,161 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include "allocationgate.h"
+
+#include <QFile>
+#include <QStringList>
+
+#include "benchmark.h"
+#include "diceparser.h"
+
+#define GATE_RUN_COUNT 8
+#define GATE_HEADROOM_PERCENT 20
+
+namespace
+{
+QString budgetText(qint64 value)
+{
+    return (value < 0) ? QStringLiteral("-") : QString::number(value);
+}
+qint64 withHeadroom(qint64 value)
+{
+    return value+(value*GATE_HEADROOM_PERCENT+99)/100;
+}
+}
+
+bool AllocationGate::load(const QString& path)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly|QIODevice::Text))
+    {
+        return false;
+    }
+    QTextStream in(&file);
+    in.setCodec("UTF-8");
+    m_budgets.clear();
+    while(!in.atEnd())
+    {
+        QString line = in.readLine();
+        if(line.trimmed().isEmpty()||line.startsWith(QLatin1Char('#')))
+        {
+            continue;
+        }
+        QStringList fields = line.split(QLatin1Char('\t'));
+        Budget budget;
+        budget.command = fields.at(0).trimmed();
+        bool ok = false;
+        budget.allocations = (fields.size() > 1) ? fields.at(1).toLongLong(&ok) : -1;
+        if(!ok)
+        {
+            budget.allocations = -1;
+        }
+        budget.bytes = (fields.size() > 2) ? fields.at(2).toLongLong(&ok) : -1;
+        if(!ok)
+        {
+            budget.bytes = -1;
+        }
+        m_budgets.append(budget);
+    }
+    return true;
+}
+AllocationGate::Budget AllocationGate::measure(const QString& command)
+{
+    Budget result = {command,-1,-1};
+    DiceParser parser;
+    // the first run fills what is built once (tables, caches of Qt): it is not measured.
+    if(!parser.parseLine(command))
+    {
+        return result;
+    }
+    parser.Start();
+    // no seed: a seeded parser draws from per-instruction streams, the production path does not.
+    for(int run = 0; run < GATE_RUN_COUNT; ++run)
+    {
+        const quint64 allocations = AllocationCounter::getCount();
+        const quint64 bytes = AllocationCounter::getBytes();
+        parser.parseLine(command);
+        parser.Start();
+        result.allocations = qMax<qint64>(result.allocations,AllocationCounter::getCount()-allocations);
+        result.bytes = qMax<qint64>(result.bytes,AllocationCounter::getBytes()-bytes);
+    }
+    return result;
+}
+int AllocationGate::check(QTextStream& out) const
+{
+    if(!AllocationCounter::isSupported())
+    {
+        out << "Allocations can not be counted on this platform\n";
+        return 1;
+    }
+    int status = 0;
+    for(const Budget& budget : m_budgets)
+    {
+        Budget measured = measure(budget.command);
+        QString verdict = QStringLiteral("ok");
+        if(measured.allocations < 0)
+        {
+            verdict = QStringLiteral("FAIL does not parse");
+            status = 1;
+        }
+        else if((budget.allocations < 0)||(budget.bytes < 0))
+        {
+            // a command without budget would always pass.
+            verdict = QStringLiteral("FAIL no budget, run --record-gate");
+            status = 1;
+        }
+        else if((measured.allocations > budget.allocations)||(measured.bytes > budget.bytes))
+        {
+            verdict = QStringLiteral("FAIL over budget");
+            status = 1;
+        }
+        out << budget.command << ": " << measured.allocations << "/" << budgetText(budget.allocations) << " allocs, "
+            << measured.bytes << "/" << budgetText(budget.bytes) << " bytes " << verdict << "\n";
+    }
+    return status;
+}
+int AllocationGate::record(const QString& path,QTextStream& out) const
+{
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly|QIODevice::Text))
+    {
+        out << "Can not write " << path << "\n";
+        return 1;
+    }
+    QTextStream budgets(&file);
+    budgets.setCodec("UTF-8");
+    budgets << "# command\tmax allocations\tmax bytes, for one parseLine() and Start()\n";
+    budgets << "# recorded by diceparser_bench --record-gate with " << GATE_HEADROOM_PERCENT << "% headroom\n";
+    int status = 0;
+    for(const Budget& budget : m_budgets)
+    {
+        Budget measured = measure(budget.command);
+        if(measured.allocations < 0)
+        {
+            out << budget.command << ": does not parse\n";
+            budgets << budget.command << "\t-\t-\n";
+            status = 1;
+            continue;
+        }
+        budgets << budget.command << "\t" << withHeadroom(measured.allocations) << "\t" << withHeadroom(measured.bytes) << "\n";
+    }
+    return status;
+}
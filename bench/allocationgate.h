@@ -0,0 +1,80 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef ALLOCATIONGATE_H
+#define ALLOCATIONGATE_H
+
+#include <QString>
+#include <QList>
+#include <QTextStream>
+
+/**
+ * @brief The AllocationGate class checks the allocations of commands against the budgets of a file.
+ *
+ * Each line of the file is "command<TAB>allocations<TAB>bytes", # starts a comment. A command is parsed and run
+ * (DiceParser::parseLine() then Start()) several times as the front ends do: the most allocations and bytes of one run
+ * must stay under its budget. "-" as budget means not measured yet and fails the check, record() writes the measures
+ * with some headroom.
+ */
+class AllocationGate
+{
+public:
+    /**
+     * @brief The Budget struct, the limits of one command, -1 when not set.
+     */
+    struct Budget
+    {
+        QString command;
+        qint64 allocations;
+        qint64 bytes;
+    };
+    /**
+     * @brief load reads the budgets.
+     * @param path
+     * @return false if the file can not be read.
+     */
+    bool load(const QString& path);
+    /**
+     * @brief check runs each command and reports the budgets exceeded.
+     * @param out
+     * @return exit code, 1 if a budget is exceeded or missing, or if a command does not parse.
+     */
+    int check(QTextStream& out) const;
+    /**
+     * @brief record writes the budgets file again with the measures of this build plus headroom.
+     * @param path
+     * @param out
+     * @return exit code.
+     */
+    int record(const QString& path,QTextStream& out) const;
+
+private:
+    /**
+     * @brief measure
+     * @return the most allocations and bytes of one run of the command, -1 if it does not parse.
+     */
+    static AllocationGate::Budget measure(const QString& command);
+
+private:
+    QList<AllocationGate::Budget> m_budgets;
+};
+
+#endif // ALLOCATIONGATE_H
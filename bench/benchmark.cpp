@@ -0,0 +1,258 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include "benchmark.h"
+
+#include <QTextStream>
+#include <QRegularExpression>
+#include <QStringList>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+std::atomic<quint64> s_allocations(0);
+std::atomic<quint64> s_bytes(0);
+
+inline void record(std::size_t size)
+{
+    s_allocations.fetch_add(1,std::memory_order_relaxed);
+    s_bytes.fetch_add(size,std::memory_order_relaxed);
+}
+}
+
+#ifdef __GLIBC__
+// Qt containers allocate with malloc: it is wrapped, operator new of libstdc++ goes through it as well.
+extern "C"
+{
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count,std::size_t size);
+void* __libc_realloc(void* pointer,std::size_t size);
+
+void* malloc(std::size_t size)
+{
+    record(size);
+    return __libc_malloc(size);
+}
+void* calloc(std::size_t count,std::size_t size)
+{
+    record(count*size);
+    return __libc_calloc(count,size);
+}
+void* realloc(void* pointer,std::size_t size)
+{
+    record(size);
+    return __libc_realloc(pointer,size);
+}
+}
+#endif
+
+quint64 AllocationCounter::getCount()
+{
+    return s_allocations.load(std::memory_order_relaxed);
+}
+quint64 AllocationCounter::getBytes()
+{
+    return s_bytes.load(std::memory_order_relaxed);
+}
+bool AllocationCounter::isSupported()
+{
+#ifdef __GLIBC__
+    return true;
+#else
+    return false;
+#endif
+}
+
+BenchmarkState::BenchmarkState(quint64 iterations)
+    : m_iterations(iterations),m_done(0),m_running(false),m_skipped(false),m_nanoseconds(0),
+      m_allocationStart(0),m_bytesStart(0),m_allocations(0),m_bytes(0)
+{
+
+}
+bool BenchmarkState::keepRunning()
+{
+    if(m_skipped)
+    {
+        return false;
+    }
+    if(!m_running && m_done == 0)
+    {
+        resumeTiming();
+    }
+    if(m_done < m_iterations)
+    {
+        ++m_done;
+        return true;
+    }
+    if(m_running)
+    {
+        pauseTiming();
+    }
+    return false;
+}
+void BenchmarkState::pauseTiming()
+{
+    if(!m_running)
+    {
+        return;
+    }
+    m_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-m_start).count();
+    m_allocations += AllocationCounter::getCount()-m_allocationStart;
+    m_bytes += AllocationCounter::getBytes()-m_bytesStart;
+    m_running = false;
+}
+void BenchmarkState::resumeTiming()
+{
+    if(m_running)
+    {
+        return;
+    }
+    m_running = true;
+    m_allocationStart = AllocationCounter::getCount();
+    m_bytesStart = AllocationCounter::getBytes();
+    m_start = std::chrono::steady_clock::now();
+}
+void BenchmarkState::skip(const QString& reason)
+{
+    pauseTiming();
+    m_skipped = true;
+    m_skipReason = reason;
+}
+quint64 BenchmarkState::getIterations() const
+{
+    return m_iterations;
+}
+qint64 BenchmarkState::getNanoseconds() const
+{
+    return m_nanoseconds;
+}
+quint64 BenchmarkState::getAllocations() const
+{
+    return m_allocations;
+}
+quint64 BenchmarkState::getBytes() const
+{
+    return m_bytes;
+}
+bool BenchmarkState::isSkipped() const
+{
+    return m_skipped;
+}
+QString BenchmarkState::getSkipReason() const
+{
+    return m_skipReason;
+}
+
+void BenchmarkRunner::add(const QString& name,const Function& function)
+{
+    m_benchmarks.append({name,function});
+}
+int BenchmarkRunner::run(const QStringList& arguments)
+{
+    QTextStream out(stdout, QIODevice::WriteOnly);
+    QRegularExpression filter;
+    qint64 minTime = 200;
+    bool csv = false;
+    for(int i = 1; i < arguments.size(); ++i)
+    {
+        const QString& argument = arguments.at(i);
+        if((argument == QStringLiteral("--filter"))&&(i+1 < arguments.size()))
+        {
+            filter.setPattern(arguments.at(++i));
+        }
+        else if((argument == QStringLiteral("--min-time"))&&(i+1 < arguments.size()))
+        {
+            minTime = arguments.at(++i).toLongLong();
+        }
+        else if(argument == QStringLiteral("--csv"))
+        {
+            csv = true;
+        }
+    }
+    if(!filter.isValid())
+    {
+        out << "Invalid filter: " << filter.errorString() << "\n";
+        return 1;
+    }
+
+    if(csv)
+    {
+        out << "name,iterations,ns/op,allocs/op,bytes/op\n";
+    }
+    else
+    {
+        out << QStringLiteral("%1 %2 %3 %4 %5\n").arg(QStringLiteral("benchmark"),-60).arg(QStringLiteral("iterations"),12)
+               .arg(QStringLiteral("ns/op"),14).arg(QStringLiteral("allocs/op"),12).arg(QStringLiteral("bytes/op"),12);
+        if(!AllocationCounter::isSupported())
+        {
+            out << "allocations are not counted on this platform\n";
+        }
+    }
+    const qint64 minNanoseconds = minTime*1000000;
+    for(const Benchmark& benchmark : m_benchmarks)
+    {
+        if(!benchmark.name.contains(filter))
+        {
+            continue;
+        }
+        quint64 iterations = 1;
+        while(true)
+        {
+            BenchmarkState state(iterations);
+            benchmark.function(state);
+            if(state.isSkipped())
+            {
+                if(!csv)
+                {
+                    out << QStringLiteral("%1 skipped: %2\n").arg(benchmark.name,-60).arg(state.getSkipReason());
+                }
+                break;
+            }
+            const qint64 elapsed = state.getNanoseconds();
+            if((elapsed >= minNanoseconds)||(iterations >= 1000000000))
+            {
+                const double count = static_cast<double>(iterations);
+                if(csv)
+                {
+                    out << QStringLiteral("\"%1\",%2,%3,%4,%5\n").arg(QString(benchmark.name).replace('"',QStringLiteral("\"\"")))
+                           .arg(iterations).arg(elapsed/count,0,'f',1).arg(state.getAllocations()/count,0,'f',2)
+                           .arg(state.getBytes()/count,0,'f',1);
+                }
+                else
+                {
+                    out << QStringLiteral("%1 %2 %3 %4 %5\n").arg(benchmark.name,-60).arg(iterations,12)
+                           .arg(elapsed/count,14,'f',1).arg(state.getAllocations()/count,12,'f',2)
+                           .arg(state.getBytes()/count,12,'f',1);
+                }
+                out.flush();
+                break;
+            }
+            // next try aims at 1.5 times the minimum time, growing at most 10 times.
+            double factor = (elapsed > 0) ? (1.5*minNanoseconds)/elapsed : 10.0;
+            factor = qBound(2.0,factor,10.0);
+            iterations = static_cast<quint64>(iterations*factor);
+        }
+    }
+    return 0;
+}
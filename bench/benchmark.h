@@ -0,0 +1,136 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QString>
+#include <QList>
+#include <functional>
+#include <chrono>
+
+/**
+ * @brief The AllocationCounter class counts heap allocations of the process, malloc and operator new.
+ */
+class AllocationCounter
+{
+public:
+    /**
+     * @brief getCount
+     * @return number of allocations since the start of the process.
+     */
+    static quint64 getCount();
+    /**
+     * @brief getBytes
+     * @return bytes requested since the start of the process.
+     */
+    static quint64 getBytes();
+    /**
+     * @brief isSupported
+     * @return false if allocations can not be counted on this platform.
+     */
+    static bool isSupported();
+};
+
+/**
+ * @brief The BenchmarkState class drives the loop of one benchmark: while(state.keepRunning()) { ... }
+ */
+class BenchmarkState
+{
+public:
+    /**
+     * @brief BenchmarkState
+     * @param iterations number of times the loop must run.
+     */
+    explicit BenchmarkState(quint64 iterations);
+    /**
+     * @brief keepRunning starts the measure on first call and stops it after the last iteration.
+     * @return true while iterations remain.
+     */
+    bool keepRunning();
+    /**
+     * @brief pauseTiming excludes the next statements (setup of an iteration) from time and allocations.
+     */
+    void pauseTiming();
+    /**
+     * @brief resumeTiming
+     */
+    void resumeTiming();
+    /**
+     * @brief skip marks the benchmark as not measurable, with a reason (a command which does not parse...).
+     * @param reason
+     */
+    void skip(const QString& reason);
+
+    quint64 getIterations() const;
+    qint64 getNanoseconds() const;
+    quint64 getAllocations() const;
+    quint64 getBytes() const;
+    bool isSkipped() const;
+    QString getSkipReason() const;
+
+private:
+    quint64 m_iterations;
+    quint64 m_done;
+    bool m_running;
+    bool m_skipped;
+    QString m_skipReason;
+    std::chrono::steady_clock::time_point m_start;
+    qint64 m_nanoseconds;
+    quint64 m_allocationStart;
+    quint64 m_bytesStart;
+    quint64 m_allocations;
+    quint64 m_bytes;
+};
+
+/**
+ * @brief The BenchmarkRunner class runs registered benchmarks, each one long enough to be measured.
+ *
+ * Options: --filter <regex> selects benchmarks by name, --min-time <ms> sets the measure time of each benchmark,
+ * --csv writes name,iterations,ns/op,allocs/op,bytes/op for comparison between two builds.
+ */
+class BenchmarkRunner
+{
+public:
+    typedef std::function<void(BenchmarkState&)> Function;
+    /**
+     * @brief add registers a benchmark.
+     * @param name
+     * @param function runs the measured loop, see BenchmarkState.
+     */
+    void add(const QString& name,const Function& function);
+    /**
+     * @brief run
+     * @param arguments command line options.
+     * @return exit code.
+     */
+    int run(const QStringList& arguments);
+
+private:
+    struct Benchmark
+    {
+        QString name;
+        Function function;
+    };
+    QList<Benchmark> m_benchmarks;
+};
+
+#endif // BENCHMARK_H
@@ -0,0 +1,159 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include "groupcheck.h"
+
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+
+#include <algorithm>
+#include <random>
+
+#define GROUP_CHECK_SEED 1
+#define GROUP_CHECK_POOLS 5000
+#define GROUP_CHECK_MAX_DICE 12
+#define GROUP_TIMING_DICE 50
+#define GROUP_TIMING_POOLS 20
+#define GROUP_TIMING_LIMIT_MS 100
+
+int GroupCheck::run(QTextStream& out) const
+{
+    std::mt19937 generator(GROUP_CHECK_SEED);
+    const int faces[] = {2,3,4,6,8,10,12,20,100};
+    int status = 0;
+    int mismatches = 0;
+    for(int pool = 0; pool < GROUP_CHECK_POOLS; ++pool)
+    {
+        const int face = faces[generator()%(sizeof(faces)/sizeof(faces[0]))];
+        const int count = 1+static_cast<int>(generator()%GROUP_CHECK_MAX_DICE);
+        const qint64 groupValue = 1+static_cast<qint64>(generator()%(3*face));
+        DieGroup values;
+        for(int i = 0; i < count; ++i)
+        {
+            values << 1+static_cast<qint64>(generator()%face);
+        }
+        GroupNode node;
+        node.setGroupValue(groupValue);
+        QList<DieGroup> groups = node.getGroup(values);
+        const int expected = countGroups(values,groupValue);
+        if((groups.size() != expected)||(!isValid(values,groups,groupValue)))
+        {
+            QStringList text;
+            for(qint64 value : values)
+            {
+                text << QString::number(value);
+            }
+            out << "FAIL group " << groupValue << " of " << text.join(',') << ": " << groups.size() << " groups, "
+                << expected << " expected\n";
+            ++mismatches;
+            status = 1;
+        }
+    }
+    out << GROUP_CHECK_POOLS << " pools of up to " << GROUP_CHECK_MAX_DICE << " dice: " << mismatches << " mismatches\n";
+
+    // 50d10 grouped by several values, the time of the slowest pool.
+    for(qint64 groupValue : {7,11,13,15,17,23,31})
+    {
+        qint64 slowest = 0;
+        for(int pool = 0; pool < GROUP_TIMING_POOLS; ++pool)
+        {
+            DieGroup values;
+            for(int i = 0; i < GROUP_TIMING_DICE; ++i)
+            {
+                values << 1+static_cast<qint64>(generator()%10);
+            }
+            GroupNode node;
+            node.setGroupValue(groupValue);
+            QElapsedTimer timer;
+            timer.start();
+            node.getGroup(values);
+            slowest = qMax(slowest,timer.nsecsElapsed());
+        }
+        const bool slow = (slowest > GROUP_TIMING_LIMIT_MS*Q_INT64_C(1000000));
+        out << GROUP_TIMING_DICE << "d10 g" << groupValue << ": " << slowest/1000 << " us for the slowest pool"
+            << (slow ? " FAIL over " : " limit ") << GROUP_TIMING_LIMIT_MS << " ms\n";
+        if(slow)
+        {
+            status = 1;
+        }
+    }
+    return status;
+}
+int GroupCheck::countGroups(const DieGroup& values,qint64 groupValue)
+{
+    // best[mask]: most groups made of the dice of mask. The lowest die of mask is either unused or in a group
+    // made of it and any subset of the other dice.
+    const int count = values.size();
+    const int size = 1 << count;
+    QVector<qint64> sums(size,0);
+    QVector<int> best(size,0);
+    for(int mask = 1; mask < size; ++mask)
+    {
+        int low = 0;
+        while(!(mask & (1 << low)))
+        {
+            ++low;
+        }
+        sums[mask] = sums[mask & (mask-1)]+values.at(low);
+    }
+    for(int mask = 1; mask < size; ++mask)
+    {
+        const int low = mask & -mask;
+        const int others = mask ^ low;
+        int result = best[others];
+        for(int subset = others; ; subset = (subset-1) & others)
+        {
+            const int group = subset | low;
+            if(sums[group] >= groupValue)
+            {
+                result = qMax(result,1+best[mask ^ group]);
+            }
+            if(0 == subset)
+            {
+                break;
+            }
+        }
+        best[mask] = result;
+    }
+    return best[size-1];
+}
+bool GroupCheck::isValid(const DieGroup& values,const QList<DieGroup>& groups,qint64 groupValue)
+{
+    DieGroup remaining(values);
+    for(const DieGroup& group : groups)
+    {
+        qint64 sum = 0;
+        for(qint64 value : group)
+        {
+            if(!remaining.removeOne(value))
+            {
+                return false;
+            }
+            sum += value;
+        }
+        if(sum < groupValue)
+        {
+            return false;
+        }
+    }
+    return true;
+}
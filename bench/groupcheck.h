@@ -0,0 +1,59 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef GROUPCHECK_H
+#define GROUPCHECK_H
+
+#include <QTextStream>
+
+#include "node/groupnode.h"
+
+/**
+ * @brief The GroupCheck class compares the branch and bound search of GroupNode with an exhaustive search.
+ *
+ * Random pools of up to 12 dice are grouped by GroupNode::getGroup(): the groups must reach the group value, use each
+ * die once at most, and be as many as the exhaustive search finds. Pools of 50 dice are then timed, the slowest one
+ * must stay under a limit.
+ */
+class GroupCheck
+{
+public:
+    /**
+     * @brief run
+     * @param out
+     * @return exit code, 1 if a pool is grouped differently or too slowly.
+     */
+    int run(QTextStream& out) const;
+
+private:
+    /**
+     * @brief countGroups exhaustive search over the subsets of values, for small pools.
+     * @return the greatest number of disjoint subsets whose sums reach groupValue.
+     */
+    static int countGroups(const DieGroup& values,qint64 groupValue);
+    /**
+     * @brief isValid
+     * @return true if each group reaches groupValue and the groups only use values of the pool.
+     */
+    static bool isValid(const DieGroup& values,const QList<DieGroup>& groups,qint64 groupValue);
+};
+
+#endif // GROUPCHECK_H
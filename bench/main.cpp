@@ -0,0 +1,247 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+
+#include "benchmark.h"
+#include "allocationgate.h"
+#include "groupcheck.h"
+#include "diceparser.h"
+#include "diceformatter.h"
+
+/**
+ * @page Bench
+ * Micro benchmarks of DiceParser: parsing, running, reading results and formatting, for each command of
+ * cli/cmds.txt and for synthetic commands which grow (number of dice, explosions, parentheses, aliases).
+ * Run "diceparser_bench --csv" on two builds and compare ns/op, allocs/op and bytes/op.
+ * "diceparser_bench --gate [file]" checks the allocations of commands against bench/allocation_budgets.txt and fails
+ * when one is exceeded, "--record-gate [file]" writes the budgets of the current build, see AllocationGate.
+ * "diceparser_bench --check-group" compares the group search (g) with an exhaustive search and times it, see GroupCheck.
+ */
+
+namespace
+{
+/**
+ * @brief The Command struct, one command of the corpus with the aliases it needs.
+ */
+struct Command
+{
+    QString name;
+    QString text;
+    int aliasCount;
+};
+
+void insertAliases(DiceParser& parser,int count)
+{
+    for(int i = 0; i < count; ++i)
+    {
+        parser.insertAlias(new DiceAlias(QStringLiteral("alias%1x").arg(i),QStringLiteral("%1d6").arg(i%10+1)),i);
+    }
+}
+/**
+ * @brief prepare parses and runs a command out of the measure.
+ * @return false if the command does not parse.
+ */
+bool prepare(BenchmarkState& state,DiceParser& parser,const Command& command)
+{
+    state.pauseTiming();
+    bool parsed = parser.parseLine(command.text);
+    if(parsed)
+    {
+        parser.Start();
+    }
+    else
+    {
+        state.skip(QStringLiteral("does not parse"));
+    }
+    state.resumeTiming();
+    return parsed;
+}
+template <class Format>
+void addFormatBenchmark(BenchmarkRunner& runner,const QString& formatName,const Command& command)
+{
+    runner.add(QStringLiteral("format/%1/%2").arg(formatName).arg(command.name),[command](BenchmarkState& state)
+    {
+        DiceParser parser;
+        insertAliases(parser,command.aliasCount);
+        if(!prepare(state,parser,command))
+        {
+            return;
+        }
+        QByteArray buffer;
+        buffer.reserve(4096);
+        // formatting only reads the results: the same run is formatted again and again.
+        while(state.keepRunning())
+        {
+            buffer.resize(0);
+            DiceFormatter<Format> formatter(buffer);
+            formatter.format(parser);
+        }
+    });
+}
+void addBenchmarks(BenchmarkRunner& runner,const Command& command)
+{
+    runner.add(QStringLiteral("parse/%1").arg(command.name),[command](BenchmarkState& state)
+    {
+        DiceParser parser;
+        insertAliases(parser,command.aliasCount);
+        while(state.keepRunning())
+        {
+            if(!parser.parseLine(command.text))
+            {
+                state.skip(QStringLiteral("does not parse"));
+            }
+        }
+    });
+    runner.add(QStringLiteral("start/%1").arg(command.name),[command](BenchmarkState& state)
+    {
+        DiceParser parser;
+        insertAliases(parser,command.aliasCount);
+        // a tree runs once: each iteration parses again, out of the measure.
+        while(state.keepRunning())
+        {
+            state.pauseTiming();
+            if(!parser.parseLine(command.text))
+            {
+                state.skip(QStringLiteral("does not parse"));
+                break;
+            }
+            state.resumeTiming();
+            parser.Start();
+        }
+    });
+    runner.add(QStringLiteral("results/%1").arg(command.name),[command](BenchmarkState& state)
+    {
+        DiceParser parser;
+        insertAliases(parser,command.aliasCount);
+        while(state.keepRunning())
+        {
+            if(!prepare(state,parser,command))
+            {
+                break;
+            }
+            QList<ExportedDiceResult> dice;
+            bool homogeneous = true;
+            bool hasAlias = false;
+            parser.getLastIntegerResults();
+            parser.getSumOfDiceResult();
+            parser.getAllDiceResult(hasAlias);
+            parser.getLastDiceResult(dice,homogeneous);
+        }
+    });
+    addFormatBenchmark<TextFormat>(runner,QStringLiteral("text"),command);
+    addFormatBenchmark<AnsiFormat>(runner,QStringLiteral("ansi"),command);
+    addFormatBenchmark<MarkdownFormat>(runner,QStringLiteral("markdown"),command);
+    addFormatBenchmark<HtmlFormat>(runner,QStringLiteral("html"),command);
+    addFormatBenchmark<JsonFormat>(runner,QStringLiteral("json"),command);
+}
+QList<Command> buildCorpus(const QString& cmdsPath)
+{
+    QList<Command> corpus;
+    QFile file(cmdsPath);
+    if(file.open(QIODevice::ReadOnly|QIODevice::Text))
+    {
+        QTextStream in(&file);
+        in.setCodec("UTF-8");
+        while(!in.atEnd())
+        {
+            QString line = in.readLine().trimmed();
+            if(!line.isEmpty())
+            {
+                corpus.append({QStringLiteral("cmds/%1").arg(line),line,0});
+            }
+        }
+    }
+    for(int count : {1,10,100,1000,10000,100000})
+    {
+        corpus.append({QStringLiteral("dice/%1").arg(count),QStringLiteral("%1d6").arg(count),0});
+    }
+    for(int count : {10,100,1000})
+    {
+        corpus.append({QStringLiteral("explosions/%1").arg(count),QStringLiteral("%1d10e[>=2]").arg(count),0});
+    }
+    for(int depth : {1,10,50})
+    {
+        QString text = QStringLiteral("1d6");
+        for(int i = 0; i < depth; ++i)
+        {
+            text = QStringLiteral("(%1+1)").arg(text);
+        }
+        corpus.append({QStringLiteral("parentheses/%1").arg(depth),text,0});
+    }
+    for(int count : {1,10,100,1000})
+    {
+        corpus.append({QStringLiteral("aliases/%1").arg(count),QStringLiteral("alias%1x").arg(count-1),count});
+    }
+    return corpus;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc,argv);
+    QStringList arguments = app.arguments();
+    QString cmdsPath = QStringLiteral(DICE_CMDS_PATH);
+    int index = arguments.indexOf(QStringLiteral("--cmds"));
+    if((index >= 0)&&(index+1 < arguments.size()))
+    {
+        cmdsPath = arguments.at(index+1);
+    }
+
+    if(arguments.contains(QStringLiteral("--check-group")))
+    {
+        QTextStream out(stdout, QIODevice::WriteOnly);
+        GroupCheck check;
+        return check.run(out);
+    }
+
+    for(const QString& option : {QStringLiteral("--gate"),QStringLiteral("--record-gate")})
+    {
+        index = arguments.indexOf(option);
+        if(index < 0)
+        {
+            continue;
+        }
+        QTextStream out(stdout, QIODevice::WriteOnly);
+        QString gatePath = QStringLiteral(DICE_GATE_PATH);
+        if((index+1 < arguments.size())&&(!arguments.at(index+1).startsWith(QStringLiteral("--"))))
+        {
+            gatePath = arguments.at(index+1);
+        }
+        AllocationGate gate;
+        if(!gate.load(gatePath))
+        {
+            out << "Can not read " << gatePath << "\n";
+            return 1;
+        }
+        return (option == QStringLiteral("--gate")) ? gate.check(out) : gate.record(gatePath,out);
+    }
+
+    BenchmarkRunner runner;
+    for(const Command& command : buildCorpus(cmdsPath))
+    {
+        addBenchmarks(runner,command);
+    }
+    return runner.run(arguments);
+}
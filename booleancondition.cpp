@@ -84,6 +84,14 @@ void BooleanCondition::setValue(qint64 v)
 {
     m_value=v;
 }
+BooleanCondition::LogicOperator BooleanCondition::getOperator() const
+{
+    return m_operator;
+}
+qint64 BooleanCondition::getValue() const
+{
+    return m_value;
+}
 QString BooleanCondition::toString()
 {
 	QString str(QStringLiteral(""));
@@ -38,6 +38,8 @@ public:
 
     void setOperator(LogicOperator m);
     void setValue(qint64);
+    LogicOperator getOperator() const;
+    qint64 getValue() const;
     QString toString();
 
     virtual quint64 getValidRangeSize(quint64 faces) const;
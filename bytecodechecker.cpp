@@ -0,0 +1,115 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include "bytecodechecker.h"
+
+#include <random>
+#include <QStringList>
+
+#include "diceparser.h"
+#include "diceformatter.h"
+#include "die.h"
+
+BytecodeChecker::BytecodeChecker()
+    : m_status(SAME)
+{
+
+}
+bool BytecodeChecker::check(const QString& command,quint32 seed)
+{
+    Outcome tree = evaluate(command,seed,false);
+    Outcome vm = evaluate(command,seed,true);
+
+    if(!tree.parsed)
+    {
+        m_status = PARSING_ERROR;
+        m_report = QStringLiteral("PARSING ERROR %1").arg(command);
+    }
+    else if(!vm.bytecode)
+    {
+        m_status = NOT_COMPILED;
+        m_report = QStringLiteral("NOT COMPILED %1").arg(command);
+    }
+    else if((tree.scalars == vm.scalars)&&(tree.diceSums == vm.diceSums)&&(tree.dice == vm.dice)&&(tree.errors == vm.errors))
+    {
+        m_status = SAME;
+        m_report = QStringLiteral("SAME %1").arg(command);
+    }
+    else
+    {
+        m_status = DIFFERENT;
+        m_report = QStringLiteral("DIFFERENT %1 (seed %2)\n  tree: %3\n  vm:   %4").arg(command).arg(seed)
+                .arg(toString(tree)).arg(toString(vm));
+    }
+    return m_status != DIFFERENT;
+}
+BytecodeChecker::STATUS BytecodeChecker::getStatus() const
+{
+    return m_status;
+}
+QString BytecodeChecker::getReport() const
+{
+    return m_report;
+}
+BytecodeChecker::Outcome BytecodeChecker::evaluate(const QString& command,quint32 seed,bool bytecode) const
+{
+    Outcome outcome;
+    DiceParser parser;
+    parser.setBytecodeEnabled(bytecode);
+    if(!parser.parseLine(command))
+    {
+        return outcome;
+    }
+    outcome.parsed = true;
+
+    std::mt19937 generator(seed);
+    Die::RandomScope randomScope(&generator);
+    parser.Start();
+
+    outcome.bytecode = parser.hasBytecode();
+    outcome.scalars = parser.getLastIntegerResults();
+    outcome.diceSums = parser.getSumOfDiceResult();
+    DiceFormatter<JsonFormat> formatter(outcome.dice);
+    formatter.format(parser);
+    QStringList errors;
+    const auto errorMap = parser.getErrorMap();
+    for(auto it = errorMap.constBegin(); it != errorMap.constEnd(); ++it)
+    {
+        errors << QStringLiteral("%1:%2").arg(it.key()).arg(it.value());
+    }
+    outcome.errors = errors.join(QStringLiteral("|"));
+    return outcome;
+}
+QString BytecodeChecker::toString(const Outcome& outcome)
+{
+    QStringList scalars;
+    for(qreal value : outcome.scalars)
+    {
+        scalars << QString::number(value);
+    }
+    QStringList sums;
+    for(qreal value : outcome.diceSums)
+    {
+        sums << QString::number(value);
+    }
+    return QStringLiteral("scalars [%1] sums [%2] dice %3 errors [%4]").arg(scalars.join(',')).arg(sums.join(','))
+            .arg(QString::fromUtf8(outcome.dice)).arg(outcome.errors);
+}
@@ -0,0 +1,85 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef BYTECODECHECKER_H
+#define BYTECODECHECKER_H
+
+#include <QString>
+#include <QList>
+#include <QByteArray>
+
+/**
+ * @brief The BytecodeChecker class runs a command on the tree and on DiceVm with the same seed, and compares them.
+ *
+ * Scalar results, sums of dice, dice (values, rolls and highlight, written with JsonFormat) and errors must be the
+ * same. Commands which do not compile to bytecode are reported but are not a failure.
+ */
+class BytecodeChecker
+{
+public:
+    /**
+     * @brief The STATUS enum
+     */
+    enum STATUS {SAME,NOT_COMPILED,PARSING_ERROR,DIFFERENT};
+    /**
+     * @brief BytecodeChecker
+     */
+    BytecodeChecker();
+    /**
+     * @brief check
+     * @param command
+     * @param seed of the generator shared by all dice of a run.
+     * @return false if the results of both backends are different.
+     */
+    bool check(const QString& command,quint32 seed);
+    /**
+     * @brief getStatus
+     * @return status of the last check.
+     */
+    BytecodeChecker::STATUS getStatus() const;
+    /**
+     * @brief getReport
+     * @return one line describing the last check, with both results when they are different.
+     */
+    QString getReport() const;
+
+private:
+    /**
+     * @brief The Outcome struct, what is compared for one backend.
+     */
+    struct Outcome
+    {
+        bool parsed = false;
+        bool bytecode = false;
+        QList<qreal> scalars;
+        QList<qreal> diceSums;
+        QByteArray dice;
+        QString errors;
+    };
+    Outcome evaluate(const QString& command,quint32 seed,bool bytecode) const;
+    static QString toString(const Outcome& outcome);
+
+private:
+    STATUS m_status;
+    QString m_report;
+};
+
+#endif // BYTECODECHECKER_H
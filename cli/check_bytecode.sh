@@ -0,0 +1,18 @@
+#!/bin/sh
+# Compares the tree and the bytecode VM on every command of cmds.txt, with a few seeds.
+# usage: check_bytecode.sh <path to dice> [seeds...]
+
+DICE="${1:-./dice}"
+shift
+SEEDS="${@:-1 42 1234}"
+STATUS=0
+
+for seed in $SEEDS
+do
+  for line in `cat cmds.txt`
+  do
+    report=`$DICE --check-bytecode $seed $line` || STATUS=1
+    echo "$report" | grep -v "^SAME"
+  done
+done
+exit $STATUS
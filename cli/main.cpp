@@ -25,7 +25,9 @@
 #include <QCommandLineParser>
 #include <QCommandLineOption>
 #include <QTextStream>
-#include "highlightdice.h"
+#include <QFile>
+#include "diceformatter.h"
+#include "bytecodechecker.h"
 
 /**
  * @page Dice
@@ -44,188 +46,57 @@
 
 QTextStream out(stdout, QIODevice::WriteOnly);
 bool markdown = false;
-QString diceToMarkdown(QList<ExportedDiceResult>& diceList,bool highlight,bool homogeneous)
+bool bytecode = false;
+bool parallel = false;
+qint64 seed = -1;
+QString traceFile;
+QString foldedFile;
+/**
+ * @brief writeProfile writes the events of all commands to the files given by --trace and --folded.
+ */
+void writeProfile(const ExecutionProfiler& profiler)
 {
-    QStringList global;
-    for(auto dice : diceList)
+    if(!traceFile.isEmpty())
     {
-        QStringList resultGlobal;
-        for(int face:  dice.keys())
+        QFile file(traceFile);
+        if(file.open(QIODevice::WriteOnly))
         {
-            QStringList result;
-            QStringList currentStreak;
-            QList<QStringList> allStreakList;
-            ListDiceResult diceResult =  dice.value(face);
-            bool previousHighlight=false;
-            QString previousColor;
-            QString patternColor("");
-            for (const HighLightDice& tmp : diceResult)
-            {
-                if(previousColor != tmp.getColor())
-                {
-                    if(!currentStreak.isEmpty())
-                    {
-                        QStringList list;
-                        list << patternColor+currentStreak.join(',');
-                        allStreakList.append(list);
-                        currentStreak.clear();
-                    }
-                    patternColor = QStringLiteral("");
-
-                }
-                QStringList diceListStr;
-                if((previousHighlight)&&(!tmp.isHighlighted()))
-                {
-                    if(!currentStreak.isEmpty())
-                    {
-                        QStringList list;
-                        list << patternColor+currentStreak.join(',');
-                        allStreakList.append(list);
-                        currentStreak.clear();
-                    }
-
-                }
-                else if((!previousHighlight)&&(tmp.isHighlighted()))
-                {
-                    if(!currentStreak.isEmpty())
-                    {
-                        QStringList list;
-                        list << currentStreak.join(',');
-                        allStreakList.append(list);
-                        currentStreak.clear();
-                    }
-                }
-                previousHighlight = tmp.isHighlighted();
-                previousColor = tmp.getColor();
-                for(int i =0; i < tmp.getResult().size(); ++i)
-                {
-                    qint64 dievalue = tmp.getResult()[i];
-                    diceListStr << QString::number(dievalue);
-                }
-                if(diceListStr.size()>1)
-                {
-                    QString first = diceListStr.takeFirst();
-                    first = QString("%1 [%2]").arg(first).arg(diceListStr.join(','));
-                    diceListStr.clear();
-                    diceListStr << first;
-                }
-                currentStreak << diceListStr.join(' ');
-            }
-
-            if(previousHighlight)
-            {
-                QStringList list;
-                list <<  patternColor+currentStreak.join(',');
-                allStreakList.append(list);
-            }
-            else
-            {
-                if(!currentStreak.isEmpty())
-                {
-                    QStringList list;
-                    list << currentStreak.join(',');
-                    allStreakList.append(list);
-                }
-            }
-            for(const QStringList& a : allStreakList)
-            {
-                result << a;
-            }
-            if(dice.keys().size()>1)
-            {
-                resultGlobal << QString(" d%2:(%1)").arg(result.join(",")).arg(face);
-            }
-            else
-            {
-                resultGlobal << result.join(",");
-            }
+            file.write(profiler.toChromeTrace());
         }
-        global << resultGlobal.join("");
     }
-    return global.join(";");
-}
-
-QString diceToText(QList<ExportedDiceResult>& diceList,bool highlight,bool homogeneous)
-{
-    QStringList global;
-    for(auto dice : diceList)
+    if(!foldedFile.isEmpty())
     {
-        QStringList resultGlobal;
-        for(int face : dice.keys())
+        QFile file(foldedFile);
+        if(file.open(QIODevice::WriteOnly))
         {
-            QStringList result;
-            ListDiceResult diceResult =  dice.value(face);
-            for (const HighLightDice& tmp : diceResult)
-            {
-                QStringList diceListStr;
-                QStringList diceListChildren;
-
-
-                for(int i =0; i < tmp.getResult().size(); ++i)
-                {
-                    qint64 dievalue = tmp.getResult()[i];
-                    QString prefix("%1");
-
-                    if((tmp.isHighlighted())&&(highlight))
-                    {
-                        if(tmp.getColor().isEmpty()|| tmp.getColor()=="black")
-                        {
-                            prefix = "\e[0;31m%1\e[0m";
-                        }
-                        if(tmp.getColor()=="white")
-                        {
-                            prefix = "\e[97m%1\e[0m";
-                        }
-                        if(tmp.getColor()=="blue")
-                        {
-                            prefix = "\e[34m%1\e[0m";
-                        }
-                        if(tmp.getColor()=="red")
-                        {
-                            prefix = "\e[31m%1\e[0m";
-                        }
-                        if(tmp.getColor()=="black")
-                        {
-                            prefix = "\e[30m%1\e[0m";
-                        }
-                    }
-
-                    if(i==0)
-                    {
-                        diceListStr << prefix.arg(QString::number(dievalue));
-                    }
-                    else
-                    {
-                        diceListChildren << prefix.arg(QString::number(dievalue));
-                    }
-                }
-                if(!diceListChildren.isEmpty())
-                {
-                    diceListStr << QString("[%1]").arg(diceListChildren.join(' '));
-                }
-
-                result << diceListStr.join(' ');
-                // qDebug() << result << tmp.first << tmp.second;
-            }
-
-            if(dice.keys().size()>1)
-            {
-                resultGlobal << QString(" d%2:(%1)").arg(result.join(',')).arg(face);
-            }
-            else
-            {
-                resultGlobal << result;
-            }
+            file.write(profiler.toFoldedStacks());
         }
-        global << resultGlobal.join(' ');
     }
-    return global.join(" ; ");
+}
+/**
+ * @brief appendDiceText appends the dice of the last run, with ANSI colors on highlighted dice when highlight is true.
+ */
+void appendDiceText(QByteArray& buffer,DiceParser& parser,bool highlight)
+{
+    if(highlight)
+    {
+        DiceFormatter<AnsiFormat> formatter(buffer);
+        formatter.format(parser);
+    }
+    else
+    {
+        DiceFormatter<TextFormat> formatter(buffer);
+        formatter.format(parser);
+    }
 }
 void startDiceParsingMarkdown(QString cmd)
 {
     QString result("");
     bool highlight = true;
     DiceParser parser;
+    parser.setBytecodeEnabled(bytecode);
+    parser.setParallelEnabled(parallel);
+    parser.setRandomSeed(seed);
 
     //setAlias
     parser.insertAlias(new DiceAlias("l5r5R","L[-,⨀,⨀⬢,❂⬢,❁,❁⬢]"),0);
@@ -235,17 +106,19 @@ void startDiceParsingMarkdown(QString cmd)
     if(parser.parseLine(cmd))
     {
         parser.Start();
-        if(!parser.getErrorMap().isEmpty())
+        if(parser.hasExecutionError())
         {
             result +=  "```markdown\n# Error:\n" + parser.humanReadableError() + "\n```";
         }
         else
         {
-            QList<ExportedDiceResult> list;
-            bool homogeneous = true;
-            parser.getLastDiceResult(list,homogeneous);
-            QString listText = diceToText(list,false,homogeneous);
-            QString diceText = diceToMarkdown(list,highlight,homogeneous);
+            QByteArray buffer;
+            appendDiceText(buffer,parser,false);
+            QString listText = QString::fromUtf8(buffer);
+            buffer.resize(0);
+            DiceFormatter<MarkdownFormat> formatter(buffer);
+            formatter.format(parser);
+            QString diceText = QString::fromUtf8(buffer);
             QString scalarText;
             QString str;
 
@@ -259,7 +132,7 @@ void startDiceParsingMarkdown(QString cmd)
                 }
                 scalarText = QString("%1").arg(strLst.join(','));
             }
-            else if(!list.isEmpty())
+            else if(parser.getStartNodeCount()>0)
             {
                 auto values = parser.getSumOfDiceResult();
                 QStringList strLst;
@@ -301,6 +174,14 @@ void startDiceParsingMarkdown(QString cmd)
 void startDiceParsing(QStringList& cmds,QString& treeFile,bool highlight)
 {
     DiceParser* parser = new DiceParser();
+    parser->setBytecodeEnabled(bytecode);
+    parser->setParallelEnabled(parallel);
+    parser->setRandomSeed(seed);
+    // the profiler is set around all commands, the parser records into it.
+    ExecutionProfiler profiler;
+    ExecutionProfiler::Scope profilerScope((traceFile.isEmpty()&&foldedFile.isEmpty()) ? nullptr : &profiler);
+    QByteArray buffer;
+    buffer.reserve(256);
 
     for(QString cmd : cmds)
     {
@@ -310,16 +191,16 @@ void startDiceParsing(QStringList& cmds,QString& treeFile,bool highlight)
             //
 
             parser->Start();
-            if(!parser->getErrorMap().isEmpty())
+            if(parser->hasExecutionError())
             {
                 out << "Error" << parser->humanReadableError() << "\n";
+                writeProfile(profiler);
                 return;
             }
 
-            QList<ExportedDiceResult> list;
-            bool homogeneous = true;
-            parser->getLastDiceResult(list,homogeneous);
-            QString diceText = diceToText(list,highlight,homogeneous);
+            buffer.resize(0);
+            appendDiceText(buffer,*parser,highlight);
+            QString diceText = QString::fromUtf8(buffer);
 
 
             QString scalarText;
@@ -335,7 +216,7 @@ void startDiceParsing(QStringList& cmds,QString& treeFile,bool highlight)
                 }
                 scalarText = QString("%1").arg(strLst.join(','));
             }
-            else if(!list.isEmpty())
+            else if(parser->getStartNodeCount()>0)
             {
                 auto values = parser->getSumOfDiceResult();
                 QStringList strLst;
@@ -370,8 +251,46 @@ void startDiceParsing(QStringList& cmds,QString& treeFile,bool highlight)
             out << parser->humanReadableError() << "\n";;
         }
     }
+    writeProfile(profiler);
     delete parser;
 }
+/**
+ * @brief checkBytecode runs each command on the tree and on the bytecode VM with the same seed.
+ * @return 1 if one command gives different results, 0 otherwise.
+ */
+int checkBytecode(const QStringList& cmds,quint32 seed)
+{
+    BytecodeChecker checker;
+    int status = 0;
+    for(const QString& cmd : cmds)
+    {
+        if(!checker.check(cmd,seed))
+        {
+            status = 1;
+        }
+        out << checker.getReport() << "\n";
+    }
+    return status;
+}
+/**
+ * @brief printErrorSpans parses and runs each command, then writes one line per error: position, length and message.
+ * Positions are indexes in the command, -1 when unknown.
+ */
+void printErrorSpans(const QStringList& cmds)
+{
+    DiceParser parser;
+    for(const QString& cmd : cmds)
+    {
+        if(parser.parseLine(cmd))
+        {
+            parser.Start();
+        }
+        for(const Diagnostics::Error& error : parser.getDiagnostics()->getErrors())
+        {
+            out << error.getPosition() << " " << error.getLength() << " " << error.getMessage() << "\n";
+        }
+    }
+}
 #include <QTextCodec>
 
 int main(int argc, char *argv[])
@@ -392,6 +311,13 @@ int main(int argc, char *argv[])
     QCommandLineOption dotFile(QStringList() << "d"<<"dot-file", "Instead of rolling dice, generate the execution tree and write it in <dotfile>","dotfile");
     QCommandLineOption translation(QStringList() << "t"<<"translation", "path to the translation file: <translationfile>","translationfile");
     QCommandLineOption help(QStringList() << "h"<<"help", "Display this help");
+    QCommandLineOption bytecodeOption(QStringList() << "b"<<"bytecode", "Run the commands on the bytecode VM when they can be compiled");
+    QCommandLineOption parallelOption(QStringList() << "parallel", "Run the instructions of a command (separated by ;) on several threads");
+    QCommandLineOption seedOption(QStringList() << "seed", "Roll the dice from <seed>: a command always gives the same results","seed");
+    QCommandLineOption traceOption(QStringList() << "trace", "Write the time, dice and memory of each node to <file>, in the Chrome trace format","file");
+    QCommandLineOption foldedOption(QStringList() << "folded", "Write the time of each node to <file> as folded stacks, for flamegraph.pl","file");
+    QCommandLineOption checkBytecodeOption(QStringList() << "check-bytecode", "Instead of displaying results, compare the tree and the bytecode VM for each command, with dice rolled from <seed>","seed");
+    QCommandLineOption errorSpansOption(QStringList() << "error-spans", "Instead of displaying results, write the position and length in the command of each error");
 
     if(!optionParser.addOption(color))
     {
@@ -404,6 +330,13 @@ int main(int argc, char *argv[])
     optionParser.addOption(discord);
     optionParser.addOption(translation);
     optionParser.addOption(help);
+    optionParser.addOption(bytecodeOption);
+    optionParser.addOption(checkBytecodeOption);
+    optionParser.addOption(errorSpansOption);
+    optionParser.addOption(parallelOption);
+    optionParser.addOption(seedOption);
+    optionParser.addOption(traceOption);
+    optionParser.addOption(foldedOption);
 
     for(int i=0;i<argc;++i)
     {
@@ -445,6 +378,23 @@ int main(int argc, char *argv[])
     }
     QStringList cmdList = optionParser.positionalArguments();
     // qDebug()<< "rest"<< cmdList;
+    bytecode = optionParser.isSet(bytecodeOption);
+    parallel = optionParser.isSet(parallelOption);
+    if(optionParser.isSet(seedOption))
+    {
+        seed = optionParser.value(seedOption).toUInt();
+    }
+    traceFile = optionParser.value(traceOption);
+    foldedFile = optionParser.value(foldedOption);
+    if(optionParser.isSet(checkBytecodeOption))
+    {
+        return checkBytecode(cmdList,optionParser.value(checkBytecodeOption).toUInt());
+    }
+    if(optionParser.isSet(errorSpansOption))
+    {
+        printErrorSpans(cmdList);
+        return 0;
+    }
 
 
     if(markdown)
@@ -1,7 +1,9 @@
 #!/bin/sh
+# Runs every command of cmds.txt, then checks where some errors point to in their command.
+# usage: test_dice.sh [path to dice]
 
-
-DICE="/home/renaud/application/mine/build-DiceParser-Qt5_7-debug-dice/cli/bin/dice"
+DICE="${1:-/home/renaud/application/mine/build-DiceParser-Qt5_7-debug-dice/cli/bin/dice}"
+STATUS=0
 
 export LD_LIBRARY_PATH="/home/renaud/application/other/Qt/5.7/gcc_64/lib:$LD_LIBRARY_PATH"
 for line in `cat cmds.txt`
@@ -9,3 +11,22 @@ do
   #echo $line;
 	$DICE $line
 done
+
+# check_span <command> <"position length"> : the first error of the command must have this span.
+check_span()
+{
+  span=`$DICE --error-spans "$1" | head -n 1 | cut -d' ' -f1,2`
+  if [ "$span" != "$2" ]
+  then
+    echo "FAIL $1: first error at \"$span\", expected \"$2\""
+    STATUS=1
+  fi
+}
+
+# the node built after its sub-expression: (1-4) is folded to a number, the error is on d6.
+check_span "(1-4)d6" "5 2"
+check_span "3d6/0" "3 1"
+# errors of an if branch point to the branch, whichever die it runs for.
+check_span "2d6i[>0]{/0}" "9 1"
+
+exit $STATUS
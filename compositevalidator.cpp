@@ -136,6 +136,14 @@ void CompositeValidator::setValidatorList(QList<Validator*>* m)
 {
     m_validatorList = m;
 }
+const QVector<CompositeValidator::LogicOperation>* CompositeValidator::getOperationList() const
+{
+    return m_operators;
+}
+const QList<Validator*>* CompositeValidator::getValidatorList() const
+{
+    return m_validatorList;
+}
 Validator* CompositeValidator::getCopy() const
 {
     QVector<LogicOperation>* vector = new QVector<LogicOperation>();
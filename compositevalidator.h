@@ -44,6 +44,8 @@ public:
 
     void setOperationList(QVector<LogicOperation>* m);
     void setValidatorList(QList<Validator*>*);
+    const QVector<LogicOperation>* getOperationList() const;
+    const QList<Validator*>* getValidatorList() const;
 
 	QString toString();
 
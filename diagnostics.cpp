@@ -0,0 +1,141 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include "diagnostics.h"
+
+namespace
+{
+thread_local Diagnostics* s_current = nullptr;
+}
+
+Diagnostics::Error::Error(ExecutionNode::DICE_ERROR_CODE code,const QString& message,const QString& nodeId,int position,int length,bool parsing)
+    : m_code(code),m_message(message),m_nodeId(nodeId),m_position(position),m_length(length),m_parsing(parsing)
+{
+
+}
+ExecutionNode::DICE_ERROR_CODE Diagnostics::Error::getCode() const
+{
+    return m_code;
+}
+QString Diagnostics::Error::getMessage() const
+{
+    return m_message;
+}
+QString Diagnostics::Error::getNodeId() const
+{
+    return m_nodeId;
+}
+int Diagnostics::Error::getPosition() const
+{
+    return m_position;
+}
+int Diagnostics::Error::getLength() const
+{
+    return m_length;
+}
+bool Diagnostics::Error::isParsingError() const
+{
+    return m_parsing;
+}
+
+Diagnostics::Scope::Scope(Diagnostics* diagnostics,const QString* parsed)
+    : m_previous(s_current),m_diagnostics(diagnostics)
+{
+    s_current = diagnostics;
+    if(nullptr!=m_diagnostics)
+    {
+        m_diagnostics->m_parsed = parsed;
+    }
+}
+Diagnostics::Scope::~Scope()
+{
+    if(nullptr!=m_diagnostics)
+    {
+        m_diagnostics->m_parsed = nullptr;
+    }
+    s_current = m_previous;
+}
+
+Diagnostics::Diagnostics()
+    : m_executionErrorCount(0),m_parsed(nullptr)
+{
+
+}
+Diagnostics* Diagnostics::current()
+{
+    return s_current;
+}
+void Diagnostics::clear(const QString& command)
+{
+    m_errors.clear();
+    m_executionErrorCount = 0;
+    m_command = command;
+}
+void Diagnostics::addError(ExecutionNode::DICE_ERROR_CODE code,const QString& message,const QString& nodeId,int position,int length)
+{
+    m_errors.append(Diagnostics::Error(code,message,nodeId,position,length,false));
+    ++m_executionErrorCount;
+}
+void Diagnostics::addParsingError(ExecutionNode::DICE_ERROR_CODE code,const QString& message)
+{
+    m_errors.append(Diagnostics::Error(code,message,QString(),getCursor(),0,true));
+}
+void Diagnostics::append(const Diagnostics& other)
+{
+    m_errors.append(other.m_errors);
+    m_executionErrorCount += other.m_executionErrorCount;
+}
+bool Diagnostics::hasError() const
+{
+    return m_executionErrorCount > 0;
+}
+const QList<Diagnostics::Error>& Diagnostics::getErrors() const
+{
+    return m_errors;
+}
+QMap<ExecutionNode::DICE_ERROR_CODE,QString> Diagnostics::getExecutionErrorMap() const
+{
+    QMap<ExecutionNode::DICE_ERROR_CODE,QString> map;
+    for(const Diagnostics::Error& error : m_errors)
+    {
+        if(error.isParsingError())
+        {
+            continue;
+        }
+        if(!map.contains(error.getCode()))
+        {
+            map.insert(error.getCode(),error.getMessage());
+        }
+        else if(!map.value(error.getCode()).split('\n').contains(error.getMessage()))
+        {
+            map[error.getCode()].append(QStringLiteral("\n%1").arg(error.getMessage()));
+        }
+    }
+    return map;
+}
+int Diagnostics::getCursor() const
+{
+    if(nullptr==m_parsed)
+    {
+        return -1;
+    }
+    return m_command.size()-m_parsed->size();
+}
@@ -0,0 +1,155 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <QList>
+#include <QMap>
+#include <QString>
+
+#include "node/executionnode.h"
+
+/**
+ * @brief The Diagnostics class collects the errors of one command as they occur.
+ *
+ * DiceParser clears its diagnostics at each parseLine() and activates them while parsing and running the tree.
+ * Nodes push their errors to Diagnostics::current(), checking for errors is then O(1) and does not walk the tree.
+ * Execution errors carry the source span the parser gave to their node, parsing errors are at the parse cursor.
+ */
+class Diagnostics
+{
+public:
+    /**
+     * @brief The Error class describes one error and where it comes from.
+     */
+    class Error
+    {
+    public:
+        Error(ExecutionNode::DICE_ERROR_CODE code,const QString& message,const QString& nodeId,int position,int length,bool parsing);
+        ExecutionNode::DICE_ERROR_CODE getCode() const;
+        QString getMessage() const;
+        /**
+         * @brief getNodeId
+         * @return id of the node which has raised the error, empty for parsing errors.
+         */
+        QString getNodeId() const;
+        /**
+         * @brief getPosition
+         * @return index in the command of the source span, -1 when unknown.
+         */
+        int getPosition() const;
+        /**
+         * @brief getLength
+         * @return length of the source span.
+         */
+        int getLength() const;
+        bool isParsingError() const;
+    private:
+        ExecutionNode::DICE_ERROR_CODE m_code;
+        QString m_message;
+        QString m_nodeId;
+        int m_position;
+        int m_length;
+        bool m_parsing;
+    };
+    /**
+     * @brief The Scope class makes diagnostics the current ones for the calling thread until it is destroyed.
+     */
+    class Scope
+    {
+    public:
+        /**
+         * @brief Scope
+         * @param diagnostics
+         * @param parsed string consumed by the parser, its remaining size gives the parse cursor.
+         */
+        explicit Scope(Diagnostics* diagnostics,const QString* parsed = nullptr);
+        ~Scope();
+    private:
+        Diagnostics* m_previous;
+        Diagnostics* m_diagnostics;
+    };
+
+    /**
+     * @brief Diagnostics
+     */
+    Diagnostics();
+    /**
+     * @brief current
+     * @return the diagnostics active on the calling thread, nullptr when none.
+     */
+    static Diagnostics* current();
+
+    /**
+     * @brief clear removes all errors and sets the command being parsed.
+     * @param command
+     */
+    void clear(const QString& command = QString());
+    /**
+     * @brief addError
+     * @param code
+     * @param message
+     * @param nodeId empty for parsing errors.
+     * @param position index of the source span, -1 when unknown.
+     * @param length
+     */
+    void addError(ExecutionNode::DICE_ERROR_CODE code,const QString& message,const QString& nodeId,int position,int length);
+    /**
+     * @brief addParsingError records an error at the parse cursor.
+     */
+    void addParsingError(ExecutionNode::DICE_ERROR_CODE code,const QString& message);
+    /**
+     * @brief append adds the errors of other diagnostics, used to gather instructions run on other threads.
+     * @param other
+     */
+    void append(const Diagnostics& other);
+    /**
+     * @brief hasError
+     * @return true if any execution error has been recorded.
+     */
+    bool hasError() const;
+    /**
+     * @brief getErrors
+     * @return every error in order of occurrence, parsing errors included.
+     */
+    const QList<Diagnostics::Error>& getErrors() const;
+    /**
+     * @brief getExecutionErrorMap
+     * @return execution errors, one entry per code. Distinct messages sharing a code are
+     * joined by newlines, an identical message is reported once. Use getErrors() for the full list.
+     */
+    QMap<ExecutionNode::DICE_ERROR_CODE,QString> getExecutionErrorMap() const;
+
+    /**
+     * @brief getCursor
+     * @return index in the command of the parser, -1 when not parsing.
+     */
+    int getCursor() const;
+
+private:
+    QList<Diagnostics::Error> m_errors;
+    int m_executionErrorCount;
+    QString m_command;
+    const QString* m_parsed;
+};
+
+#endif // DIAGNOSTICS_H
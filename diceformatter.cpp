@@ -0,0 +1,343 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include "diceformatter.h"
+
+namespace
+{
+void appendCommaDie(QByteArray& out,qint64 value,const QList<qint64>& rolls)
+{
+    out.append(QByteArray::number(value));
+    if(rolls.size()>1)
+    {
+        out.append(" [");
+        for(int i = 0; i < rolls.size(); ++i)
+        {
+            if(i>0)
+            {
+                out.append(',');
+            }
+            out.append(QByteArray::number(rolls[i]));
+        }
+        out.append(']');
+    }
+}
+void appendFaceHeader(QByteArray& out,quint64 face,int faceCount)
+{
+    if(faceCount>1)
+    {
+        out.append(" d");
+        out.append(QByteArray::number(face));
+        out.append(":(");
+    }
+}
+void appendFaceFooter(QByteArray& out,int faceCount)
+{
+    if(faceCount>1)
+    {
+        out.append(')');
+    }
+}
+}
+///////////////////////////
+/// TextFormat
+///////////////////////////
+TextFormat::TextFormat(const char* instructionSeparator)
+    : m_instructionSeparator(instructionSeparator)
+{
+
+}
+void TextFormat::beginDocument(QByteArray&)
+{
+
+}
+void TextFormat::endDocument(QByteArray&)
+{
+
+}
+void TextFormat::beginInstruction(QByteArray& out,int index)
+{
+    if(index>0)
+    {
+        out.append(m_instructionSeparator);
+    }
+}
+void TextFormat::endInstruction(QByteArray&,int)
+{
+
+}
+void TextFormat::beginFace(QByteArray& out,int index,quint64 face,int faceCount)
+{
+    if(index>0)
+    {
+        out.append(' ');
+    }
+    appendFaceHeader(out,face,faceCount);
+}
+void TextFormat::endFace(QByteArray& out,quint64,int faceCount)
+{
+    appendFaceFooter(out,faceCount);
+}
+void TextFormat::visitDie(QByteArray& out,int index,int faceCount,qint64 value,const QList<qint64>& rolls,bool,const QString&)
+{
+    writeDie(out,index,faceCount,value,rolls,"","");
+}
+void TextFormat::writeDie(QByteArray& out,int index,int faceCount,qint64 value,const QList<qint64>& rolls,const char* prefix,const char* suffix)
+{
+    if(index>0)
+    {
+        out.append(faceCount>1 ? ',' : ' ');
+    }
+    out.append(prefix);
+    out.append(QByteArray::number(value));
+    out.append(suffix);
+    if(rolls.size()>1)
+    {
+        out.append(" [");
+        for(int i = 0; i < rolls.size(); ++i)
+        {
+            if(i>0)
+            {
+                out.append(' ');
+            }
+            out.append(prefix);
+            out.append(QByteArray::number(rolls[i]));
+            out.append(suffix);
+        }
+        out.append(']');
+    }
+}
+///////////////////////////
+/// AnsiFormat
+///////////////////////////
+AnsiFormat::AnsiFormat(const char* instructionSeparator)
+    : TextFormat(instructionSeparator)
+{
+
+}
+void AnsiFormat::visitDie(QByteArray& out,int index,int faceCount,qint64 value,const QList<qint64>& rolls,bool highlighted,const QString& color)
+{
+    const char* prefix = "";
+    const char* suffix = "";
+    if(highlighted)
+    {
+        suffix = "\033[0m";
+        if(color.isEmpty())
+        {
+            prefix = "\033[0;31m";
+        }
+        else if(color == QLatin1String("black"))
+        {
+            prefix = "\033[30m";
+        }
+        else if(color == QLatin1String("white"))
+        {
+            prefix = "\033[97m";
+        }
+        else if(color == QLatin1String("blue"))
+        {
+            prefix = "\033[34m";
+        }
+        else if(color == QLatin1String("red"))
+        {
+            prefix = "\033[31m";
+        }
+        else
+        {
+            suffix = "";
+        }
+    }
+    writeDie(out,index,faceCount,value,rolls,prefix,suffix);
+}
+///////////////////////////
+/// MarkdownFormat
+///////////////////////////
+void MarkdownFormat::beginDocument(QByteArray&)
+{
+
+}
+void MarkdownFormat::endDocument(QByteArray&)
+{
+
+}
+void MarkdownFormat::beginInstruction(QByteArray& out,int index)
+{
+    if(index>0)
+    {
+        out.append(';');
+    }
+}
+void MarkdownFormat::endInstruction(QByteArray&,int)
+{
+
+}
+void MarkdownFormat::beginFace(QByteArray& out,int,quint64 face,int faceCount)
+{
+    appendFaceHeader(out,face,faceCount);
+}
+void MarkdownFormat::endFace(QByteArray& out,quint64,int faceCount)
+{
+    appendFaceFooter(out,faceCount);
+}
+void MarkdownFormat::visitDie(QByteArray& out,int index,int,qint64 value,const QList<qint64>& rolls,bool,const QString&)
+{
+    if(index>0)
+    {
+        out.append(',');
+    }
+    appendCommaDie(out,value,rolls);
+}
+///////////////////////////
+/// HtmlFormat
+///////////////////////////
+HtmlFormat::HtmlFormat()
+    : m_streakStart(0),m_previousHighlight(false)
+{
+
+}
+void HtmlFormat::beginInstruction(QByteArray& out,int index)
+{
+    if(index>0)
+    {
+        out.append(" ; ");
+    }
+}
+void HtmlFormat::beginFace(QByteArray& out,int index,quint64 face,int faceCount)
+{
+    MarkdownFormat::beginFace(out,index,face,faceCount);
+    m_previousHighlight = false;
+    m_previousColor.clear();
+    m_streakStart = out.size();
+}
+void HtmlFormat::endFace(QByteArray& out,quint64 face,int faceCount)
+{
+    if(m_previousHighlight)
+    {
+        closeStreak(out);
+    }
+    MarkdownFormat::endFace(out,face,faceCount);
+}
+void HtmlFormat::visitDie(QByteArray& out,int index,int,qint64 value,const QList<qint64>& rolls,bool highlighted,const QString& color)
+{
+    if(index>0)
+    {
+        // a streak gathers dice with the same color and highlight, it is wrapped when it is highlighted or when the
+        // color changes after it.
+        bool colorChanged = (m_previousColor != color);
+        if(colorChanged || (m_previousHighlight && !highlighted))
+        {
+            closeStreak(out);
+        }
+        out.append(',');
+        if(colorChanged || (m_previousHighlight != highlighted))
+        {
+            m_streakStart = out.size();
+        }
+    }
+    m_previousHighlight = highlighted;
+    m_previousColor = color;
+    appendCommaDie(out,value,rolls);
+}
+void HtmlFormat::closeStreak(QByteArray& out)
+{
+    if(m_previousColor.isEmpty())
+    {
+        out.insert(m_streakStart,"<span class=\"dice\">");
+    }
+    else
+    {
+        out.insert(m_streakStart,QStringLiteral("<span style=\"color:%1;font-weight:bold\">").arg(m_previousColor).toUtf8());
+    }
+    out.append("</span>");
+}
+///////////////////////////
+/// JsonFormat
+///////////////////////////
+void JsonFormat::beginDocument(QByteArray& out)
+{
+    out.append('[');
+}
+void JsonFormat::endDocument(QByteArray& out)
+{
+    out.append(']');
+}
+void JsonFormat::beginInstruction(QByteArray& out,int index)
+{
+    if(index>0)
+    {
+        out.append(',');
+    }
+    out.append('[');
+}
+void JsonFormat::endInstruction(QByteArray& out,int)
+{
+    out.append(']');
+}
+void JsonFormat::beginFace(QByteArray& out,int index,quint64 face,int)
+{
+    if(index>0)
+    {
+        out.append(',');
+    }
+    out.append("{\"face\":");
+    out.append(QByteArray::number(face));
+    out.append(",\"dice\":[");
+}
+void JsonFormat::endFace(QByteArray& out,quint64,int)
+{
+    out.append("]}");
+}
+void JsonFormat::visitDie(QByteArray& out,int index,int,qint64 value,const QList<qint64>& rolls,bool highlighted,const QString& color)
+{
+    if(index>0)
+    {
+        out.append(',');
+    }
+    out.append("{\"value\":");
+    out.append(QByteArray::number(value));
+    out.append(",\"rolls\":[");
+    for(int i = 0; i < rolls.size(); ++i)
+    {
+        if(i>0)
+        {
+            out.append(',');
+        }
+        out.append(QByteArray::number(rolls[i]));
+    }
+    out.append(highlighted ? "],\"highlight\":true,\"color\":\"" : "],\"highlight\":false,\"color\":\"");
+    for(char c : color.toUtf8())
+    {
+        if((c == '"') || (c == '\\'))
+        {
+            out.append('\\');
+            out.append(c);
+        }
+        else if((c >= 0) && (c < 0x20))
+        {
+            out.append(QStringLiteral("\\u%1").arg(static_cast<int>(c),4,16,QLatin1Char('0')).toUtf8());
+        }
+        else
+        {
+            out.append(c);
+        }
+    }
+    out.append("\"}");
+}
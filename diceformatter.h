@@ -0,0 +1,212 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef DICEFORMATTER_H
+#define DICEFORMATTER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+#include "dicevisitor.h"
+#include "diceparser.h"
+
+/**
+ * @brief The TextFormat class writes dice as plain text: "4 2 6", exploded dice as "8 [6 2]".
+ *
+ * Every format gives the same functions to DiceFormatter, they are resolved at compile time. A format writes its own
+ * separators, the index tells if the die (or face, or instruction) is the first one.
+ */
+class TextFormat
+{
+public:
+    /**
+     * @brief TextFormat
+     * @param instructionSeparator written between the dice of two instructions.
+     */
+    TextFormat(const char* instructionSeparator=" ; ");
+
+    void beginDocument(QByteArray& out);
+    void endDocument(QByteArray& out);
+    void beginInstruction(QByteArray& out,int index);
+    void endInstruction(QByteArray& out,int index);
+    void beginFace(QByteArray& out,int index,quint64 face,int faceCount);
+    void endFace(QByteArray& out,quint64 face,int faceCount);
+    void visitDie(QByteArray& out,int index,int faceCount,qint64 value,const QList<qint64>& rolls,bool highlighted,const QString& color);
+
+protected:
+    /**
+     * @brief writeDie writes the value and the rolls of one die, each number between prefix and suffix.
+     */
+    void writeDie(QByteArray& out,int index,int faceCount,qint64 value,const QList<qint64>& rolls,const char* prefix,const char* suffix);
+
+private:
+    const char* m_instructionSeparator;
+};
+
+/**
+ * @brief The AnsiFormat class is the text format with ANSI colors on highlighted dice.
+ */
+class AnsiFormat : public TextFormat
+{
+public:
+    AnsiFormat(const char* instructionSeparator=" ; ");
+
+    void visitDie(QByteArray& out,int index,int faceCount,qint64 value,const QList<qint64>& rolls,bool highlighted,const QString& color);
+};
+
+/**
+ * @brief The MarkdownFormat class writes dice separated by commas: "4,2,8 [6,2]".
+ */
+class MarkdownFormat
+{
+public:
+    void beginDocument(QByteArray& out);
+    void endDocument(QByteArray& out);
+    void beginInstruction(QByteArray& out,int index);
+    void endInstruction(QByteArray& out,int index);
+    void beginFace(QByteArray& out,int index,quint64 face,int faceCount);
+    void endFace(QByteArray& out,quint64 face,int faceCount);
+    void visitDie(QByteArray& out,int index,int faceCount,qint64 value,const QList<qint64>& rolls,bool highlighted,const QString& color);
+};
+
+/**
+ * @brief The HtmlFormat class writes dice like MarkdownFormat, streaks of highlighted dice are wrapped into a span
+ * with their color.
+ *
+ * The opening tag of a streak is known when the streak ends, it is inserted at the start of the streak then.
+ */
+class HtmlFormat : public MarkdownFormat
+{
+public:
+    HtmlFormat();
+
+    void beginInstruction(QByteArray& out,int index);
+    void beginFace(QByteArray& out,int index,quint64 face,int faceCount);
+    void endFace(QByteArray& out,quint64 face,int faceCount);
+    void visitDie(QByteArray& out,int index,int faceCount,qint64 value,const QList<qint64>& rolls,bool highlighted,const QString& color);
+
+private:
+    void closeStreak(QByteArray& out);
+
+private:
+    int m_streakStart;
+    bool m_previousHighlight;
+    QString m_previousColor;
+};
+
+/**
+ * @brief The JsonFormat class writes an array of instructions, each one is an array of dice kinds:
+ * [[{"face":10,"dice":[{"value":8,"rolls":[8],"highlight":true,"color":""}]}]]
+ */
+class JsonFormat
+{
+public:
+    void beginDocument(QByteArray& out);
+    void endDocument(QByteArray& out);
+    void beginInstruction(QByteArray& out,int index);
+    void endInstruction(QByteArray& out,int index);
+    void beginFace(QByteArray& out,int index,quint64 face,int faceCount);
+    void endFace(QByteArray& out,quint64 face,int faceCount);
+    void visitDie(QByteArray& out,int index,int faceCount,qint64 value,const QList<qint64>& rolls,bool highlighted,const QString& color);
+};
+
+/**
+ * @brief The DiceFormatter class appends the dice of the last run into a buffer, with the given format.
+ *
+ * The buffer belongs to the caller: nothing is cleared, so the same buffer can be reused from one command to the
+ * other (reserve it once, then resize it to 0) without allocating again.
+ */
+template <class Format>
+class DiceFormatter : public DiceVisitor
+{
+public:
+    /**
+     * @brief DiceFormatter
+     * @param buffer UTF-8 output, the text is appended.
+     * @param format
+     */
+    explicit DiceFormatter(QByteArray& buffer,const Format& format = Format());
+    /**
+     * @brief format appends the dice of all instructions of the parser.
+     * @param parser
+     */
+    void format(DiceParser& parser);
+
+    virtual void beginInstruction(int index);
+    virtual void endInstruction(int index);
+    virtual void beginFace(quint64 face,int faceCount);
+    virtual void endFace(quint64 face);
+    virtual void visitDie(qint64 value,const QList<qint64>& rolls,bool highlighted,const QString& color);
+
+private:
+    QByteArray& m_buffer;
+    Format m_format;
+    int m_faceIndex;
+    int m_faceCount;
+    int m_dieIndex;
+};
+
+template <class Format>
+DiceFormatter<Format>::DiceFormatter(QByteArray& buffer,const Format& format)
+    : m_buffer(buffer),m_format(format),m_faceIndex(0),m_faceCount(0),m_dieIndex(0)
+{
+
+}
+template <class Format>
+void DiceFormatter<Format>::format(DiceParser& parser)
+{
+    m_format.beginDocument(m_buffer);
+    parser.visitDice(*this);
+    m_format.endDocument(m_buffer);
+}
+template <class Format>
+void DiceFormatter<Format>::beginInstruction(int index)
+{
+    m_faceIndex = 0;
+    m_format.beginInstruction(m_buffer,index);
+}
+template <class Format>
+void DiceFormatter<Format>::endInstruction(int index)
+{
+    m_format.endInstruction(m_buffer,index);
+}
+template <class Format>
+void DiceFormatter<Format>::beginFace(quint64 face,int faceCount)
+{
+    m_dieIndex = 0;
+    m_faceCount = faceCount;
+    m_format.beginFace(m_buffer,m_faceIndex,face,faceCount);
+}
+template <class Format>
+void DiceFormatter<Format>::endFace(quint64 face)
+{
+    m_format.endFace(m_buffer,face,m_faceCount);
+    ++m_faceIndex;
+}
+template <class Format>
+void DiceFormatter<Format>::visitDie(qint64 value,const QList<qint64>& rolls,bool highlighted,const QString& color)
+{
+    m_format.visitDie(m_buffer,m_dieIndex,m_faceCount,value,rolls,highlighted,color);
+    ++m_dieIndex;
+}
+
+#endif // DICEFORMATTER_H
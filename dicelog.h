@@ -0,0 +1,76 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef DICELOG_H
+#define DICELOG_H
+
+#include <QDebug>
+
+/**
+ * @page Logging
+ * Messages are written with DICE_DEBUG(category), DICE_INFO(category) and DICE_WARNING(category), used as qDebug():
+ * @code
+ * DICE_DEBUG(PARSER) << "keep" << str;
+ * @endcode
+ * The level of each category is fixed at compile time. A message above it is in a loop which never runs: the compiler
+ * removes it with the formatting of its arguments, nothing is left in the binary.
+ *
+ * Levels: DICE_LOG_OFF (0), DICE_LOG_WARNING (1), DICE_LOG_INFO (2), DICE_LOG_DEBUG (3).
+ * DICE_LOG_LEVEL sets the level of every category (-DDICE_LOG_LEVEL=3), DICE_LOG_LEVEL_<category> overrides it for
+ * one category (-DDICE_LOG_LEVEL_SERVER=2). By default, debug messages are only kept in debug builds.
+ * Categories: PARSER (the parsing of commands), SERVER (the web server), IRC (the irc bot).
+ */
+
+#define DICE_LOG_OFF 0
+#define DICE_LOG_WARNING 1
+#define DICE_LOG_INFO 2
+#define DICE_LOG_DEBUG 3
+
+#ifndef DICE_LOG_LEVEL
+#ifdef QT_NO_DEBUG
+#define DICE_LOG_LEVEL DICE_LOG_INFO
+#else
+#define DICE_LOG_LEVEL DICE_LOG_DEBUG
+#endif
+#endif
+
+#ifndef DICE_LOG_LEVEL_PARSER
+#define DICE_LOG_LEVEL_PARSER DICE_LOG_LEVEL
+#endif
+#ifndef DICE_LOG_LEVEL_SERVER
+#define DICE_LOG_LEVEL_SERVER DICE_LOG_LEVEL
+#endif
+#ifndef DICE_LOG_LEVEL_IRC
+#define DICE_LOG_LEVEL_IRC DICE_LOG_LEVEL
+#endif
+
+#define DICE_LOG_ENABLED(category,level) ((level) <= DICE_LOG_LEVEL_##category)
+
+// the loop (as in qCDebug) keeps "if(a) DICE_DEBUG(X) << b; else ..." correct.
+#define DICE_LOG(category,level,logger) \
+    for(bool dice_log_enabled = DICE_LOG_ENABLED(category,level); dice_log_enabled; dice_log_enabled = false) \
+        logger().noquote() << "[" #category "]"
+
+#define DICE_DEBUG(category) DICE_LOG(category,DICE_LOG_DEBUG,qDebug)
+#define DICE_INFO(category) DICE_LOG(category,DICE_LOG_INFO,qInfo)
+#define DICE_WARNING(category) DICE_LOG(category,DICE_LOG_WARNING,qWarning)
+
+#endif // DICELOG_H
@@ -0,0 +1,118 @@
+# Core of DiceParser, included by each front end as diceparser.pri is by qmake projects:
+#   include(../diceparser.cmake)
+#   target_link_libraries(<front end> diceparser_core)
+# The diceparser_core library is built once per build tree, whatever the number of front ends including this file.
+# diceparser.h is its public header, the include directories come with the target.
+
+set(DICEPARSER_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+set(DICEPARSER_CORE_SOURCES
+    ${DICEPARSER_DIR}/diceparser.cpp
+    ${DICEPARSER_DIR}/range.cpp
+    ${DICEPARSER_DIR}/booleancondition.cpp
+    ${DICEPARSER_DIR}/validator.cpp
+    ${DICEPARSER_DIR}/compositevalidator.cpp
+    ${DICEPARSER_DIR}/operationcondition.cpp
+    ${DICEPARSER_DIR}/die.cpp
+    ${DICEPARSER_DIR}/evaluationbudget.cpp
+    ${DICEPARSER_DIR}/diagnostics.cpp
+    ${DICEPARSER_DIR}/parsingtoolbox.cpp
+    ${DICEPARSER_DIR}/dicealias.cpp
+    ${DICEPARSER_DIR}/result/result.cpp
+    ${DICEPARSER_DIR}/result/scalarresult.cpp
+    ${DICEPARSER_DIR}/result/stringresult.cpp
+    ${DICEPARSER_DIR}/result/diceresult.cpp
+    ${DICEPARSER_DIR}/result/dicehistogram.cpp
+    ${DICEPARSER_DIR}/node/countexecutenode.cpp
+    ${DICEPARSER_DIR}/node/fusedrollnode.cpp
+    ${DICEPARSER_DIR}/node/dicerollernode.cpp
+    ${DICEPARSER_DIR}/node/executionnode.cpp
+    ${DICEPARSER_DIR}/node/explosedicenode.cpp
+    ${DICEPARSER_DIR}/node/helpnode.cpp
+    ${DICEPARSER_DIR}/node/mergenode.cpp
+    ${DICEPARSER_DIR}/node/jumpbackwardnode.cpp
+    ${DICEPARSER_DIR}/node/keepdiceexecnode.cpp
+    ${DICEPARSER_DIR}/node/listaliasnode.cpp
+    ${DICEPARSER_DIR}/node/listsetrollnode.cpp
+    ${DICEPARSER_DIR}/node/numbernode.cpp
+    ${DICEPARSER_DIR}/node/parenthesesnode.cpp
+    ${DICEPARSER_DIR}/node/paintnode.cpp
+    ${DICEPARSER_DIR}/node/rerolldicenode.cpp
+    ${DICEPARSER_DIR}/node/scalaroperatornode.cpp
+    ${DICEPARSER_DIR}/node/sortresult.cpp
+    ${DICEPARSER_DIR}/node/startingnode.cpp
+    ${DICEPARSER_DIR}/node/filternode.cpp
+    ${DICEPARSER_DIR}/node/stringnode.cpp
+    ${DICEPARSER_DIR}/node/ifnode.cpp
+    ${DICEPARSER_DIR}/node/splitnode.cpp
+    ${DICEPARSER_DIR}/node/groupnode.cpp
+    ${DICEPARSER_DIR}/highlightdice.cpp
+    ${DICEPARSER_DIR}/resultsummary.cpp
+    ${DICEPARSER_DIR}/dicevisitor.cpp
+    ${DICEPARSER_DIR}/diceformatter.cpp
+    ${DICEPARSER_DIR}/treesimplifier.cpp
+    ${DICEPARSER_DIR}/diceprogram.cpp
+    ${DICEPARSER_DIR}/dicevm.cpp
+    ${DICEPARSER_DIR}/bytecodechecker.cpp
+    ${DICEPARSER_DIR}/executionprofiler.cpp
+)
+
+if(NOT TARGET diceparser_core)
+    find_package(Qt5Core)
+
+    option(DICE_CORE_SHARED "Build diceparser_core as a shared library" OFF)
+    option(DICE_CORE_LTO "Build diceparser_core with link time optimization" OFF)
+    set(DICE_CORE_FLAGS "" CACHE STRING "Extra compile flags of diceparser_core (-march, profile instrumentation...)")
+    set(DICE_PGO_MODE "" CACHE STRING "Profile-guided optimization of diceparser_core: GENERATE or USE (see pgo.cmake)")
+    set(DICE_PGO_PROFILE "" CACHE PATH "Clang: directory of the raw profiles (GENERATE) or merged .profdata file (USE)")
+
+    if(DICE_CORE_SHARED)
+        add_library(diceparser_core SHARED ${DICEPARSER_CORE_SOURCES})
+    else()
+        add_library(diceparser_core STATIC ${DICEPARSER_CORE_SOURCES})
+    endif()
+
+    target_include_directories(diceparser_core PUBLIC ${DICEPARSER_DIR} ${DICEPARSER_DIR}/node ${DICEPARSER_DIR}/result ${Qt5Core_INCLUDES})
+    target_compile_definitions(diceparser_core PUBLIC ${Qt5Core_DEFINITIONS})
+    target_compile_options(diceparser_core PRIVATE -std=c++11)
+    # a static core can still be linked into a shared object (plugin, mobile).
+    set_target_properties(diceparser_core PROPERTIES POSITION_INDEPENDENT_CODE ON)
+    if(NOT DICE_CORE_FLAGS STREQUAL "")
+        separate_arguments(dice_core_flags UNIX_COMMAND "${DICE_CORE_FLAGS}")
+        target_compile_options(diceparser_core PRIVATE ${dice_core_flags})
+    endif()
+    if(DICE_PGO_MODE STREQUAL "GENERATE")
+        if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+            set(dice_pgo_flag "-fprofile-instr-generate=${DICE_PGO_PROFILE}/%p.profraw")
+        else()
+            # GCC writes the .gcda files next to the objects.
+            set(dice_pgo_flag "-fprofile-generate")
+        endif()
+        target_compile_options(diceparser_core PRIVATE ${dice_pgo_flag})
+        # the program linking the core needs the profiling runtime.
+        target_link_libraries(diceparser_core INTERFACE ${dice_pgo_flag})
+    elseif(DICE_PGO_MODE STREQUAL "USE")
+        if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+            target_compile_options(diceparser_core PRIVATE "-fprofile-instr-use=${DICE_PGO_PROFILE}")
+        else()
+            target_compile_options(diceparser_core PRIVATE -fprofile-use -fprofile-correction -Wno-missing-profile)
+        endif()
+    elseif(NOT DICE_PGO_MODE STREQUAL "")
+        message(FATAL_ERROR "DICE_PGO_MODE must be GENERATE, USE or empty")
+    endif()
+    if(DICE_CORE_LTO)
+        if(CMAKE_VERSION VERSION_LESS 3.9)
+            message(WARNING "DICE_CORE_LTO needs CMake 3.9, diceparser_core is built without it")
+        else()
+            cmake_policy(SET CMP0069 NEW)
+            include(CheckIPOSupported)
+            check_ipo_supported(RESULT dice_core_ipo OUTPUT dice_core_ipo_error)
+            if(dice_core_ipo)
+                set_target_properties(diceparser_core PROPERTIES INTERPROCEDURAL_OPTIMIZATION ON)
+            else()
+                message(WARNING "DICE_CORE_LTO is not supported: ${dice_core_ipo_error}")
+            endif()
+        endif()
+    endif()
+    target_link_libraries(diceparser_core ${Qt5Core_LIBRARIES})
+endif()
@@ -20,11 +20,18 @@
 * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
 ***************************************************************************/
 #include "diceparser.h"
-#include <QDebug>
 #include <QStringList>
 #include <QObject>
 #include <QFile>
-
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QAtomicInt>
+#include <algorithm>
+#include <functional>
+#include <random>
+
+#include "dicelog.h"
 #include "node/startingnode.h"
 #include "node/scalaroperatornode.h"
 #include "node/filternode.h"
@@ -45,12 +52,46 @@
 #include "node/stringnode.h"
 #include "node/splitnode.h"
 #include "node/groupnode.h"
+#include "treesimplifier.h"
 
 
 #define DEFAULT_FACES_NUMBER 10
 
+namespace
+{
+/**
+ * @brief The InstructionRunner class runs instructions of a command on a thread of the pool.
+ */
+class InstructionRunner : public QRunnable
+{
+public:
+    InstructionRunner(const std::function<void()>& work,QSemaphore& finished)
+        : m_work(work),m_finished(finished)
+    {
+    }
+    void run()
+    {
+        m_work();
+        m_finished.release();
+    }
+private:
+    std::function<void()> m_work;
+    QSemaphore& m_finished;
+};
+/**
+ * @brief seedInstruction gives each instruction its own stream: results do not depend on the thread running it.
+ */
+void seedInstruction(std::mt19937& generator,quint32 seed,int index)
+{
+    std::seed_seq sequence{seed,static_cast<quint32>(index)};
+    generator.seed(sequence);
+}
+}
+// runners never wait, so a pool of its own cannot be filled by tasks waiting for each other.
+Q_GLOBAL_STATIC(QThreadPool,s_instructionPool)
+
 DiceParser::DiceParser()
-    : m_current(nullptr)//m_start(nullptr),
+    : m_current(nullptr),m_resultsCollected(false)//m_start(nullptr),
 {
     m_currentTreeHasSeparator =false;
     m_parsingToolbox = new ParsingToolBox();
@@ -121,6 +162,7 @@ DiceParser::~DiceParser()
         delete m_start;
         m_start = nullptr;
     }
+    clearPrograms();
 }
 ExecutionNode* DiceParser::getLatestNode(ExecutionNode* node)
 {
@@ -157,12 +199,17 @@ void DiceParser::insertAlias(DiceAlias* dice, int i)
 bool DiceParser::parseLine(QString str)
 {
     m_errorMap.clear();
+    m_budget.reset();
+    m_resultsCollected = false;
+    EvaluationBudget::Scope scope(&m_budget);
+    clearPrograms();
     if(!m_startNodes.isEmpty())
     {
         qDeleteAll(m_startNodes);
         m_startNodes.clear();
     }
     m_currentTreeHasSeparator=false;
+    m_hasMergeNode = false;
     StartingNode* start = new StartingNode();
     m_startNodes.append(start);
     ExecutionNode* newNode = nullptr;
@@ -170,6 +217,8 @@ bool DiceParser::parseLine(QString str)
 
     str = convertAlias(str);
     m_command = str;
+    m_diagnostics.clear(str);
+    Diagnostics::Scope diagnosticsScope(&m_diagnostics,&str);
     bool keepParsing = readExpression(str,newNode);
 
     if(keepParsing)
@@ -185,13 +234,20 @@ bool DiceParser::parseLine(QString str)
         }
     }
 
+    m_treeNodeCount = m_budget.getNodeCount();
+    if(m_budget.isExhausted())
+    {
+        addParsingError(ExecutionNode::BUDGET_EXCEEDED,m_budget.getErrorMessage());
+        return false;
+    }
     if((m_errorMap.isEmpty())&&(nullptr!=newNode))
     {
+        simplifyTree();
         return true;
     }
     else
     {
-        m_errorMap.insert(ExecutionNode::NOTHING_UNDERSTOOD,QObject::tr("Nothing was understood. To roll dice: !1d6 - full documation:"
+        addParsingError(ExecutionNode::NOTHING_UNDERSTOOD,QObject::tr("Nothing was understood. To roll dice: !1d6 - full documation:"
                                                                         "https://github.com/Rolisteam/DiceParser/blob/master/HelpMe.md"));
     }
     return false;
@@ -202,6 +258,7 @@ bool DiceParser::readExpression(QString& str,ExecutionNode* & node)
     ExecutionNode* operandNode=nullptr;
     QString result;
     QString comment;
+    const int start = m_diagnostics.getCursor();
     if(m_parsingToolbox->readOpenParentheses(str))
     {
         ExecutionNode* internalNode=nullptr;
@@ -209,9 +266,11 @@ bool DiceParser::readExpression(QString& str,ExecutionNode* & node)
         {
             ParenthesesNode* parentheseNode  = new ParenthesesNode();
             parentheseNode->setInternelNode(internalNode);
+            setSourceSpan(parentheseNode,start);
             node = parentheseNode;
             if(m_parsingToolbox->readCloseParentheses(str))
             {
+                setSourceSpan(parentheseNode,start);
 
                 ExecutionNode* diceNode=nullptr;
                 if(readDice(str,diceNode))
@@ -254,6 +313,8 @@ bool DiceParser::readExpression(QString& str,ExecutionNode* & node)
         {
             NumberNode* numberNode=new NumberNode();
             numberNode->setNumber(1);
+            // the implicit count of "d6" has the span of its dice.
+            numberNode->addSourceSpan(diceNode);
             numberNode->setNextNode(diceNode);
             node = numberNode;
         }
@@ -274,9 +335,11 @@ bool DiceParser::readNode(QString& str,ExecutionNode* & node)
     QString key= str.left(1);
     if(m_nodeActionMap->contains(key))
     {
+        const int start = m_diagnostics.getCursor();
         JumpBackwardNode* jumpNode = new JumpBackwardNode();
         node = jumpNode;
         str=str.remove(0,1);
+        setSourceSpan(jumpNode,start);
         readOption(str,jumpNode);
         return true;
     }
@@ -285,25 +348,219 @@ bool DiceParser::readNode(QString& str,ExecutionNode* & node)
 
 void DiceParser::Start()
 {
+    // each run has the whole budget, the nodes of the parsed tree stay charged.
+    m_budget.reset();
+    m_budget.addNodes(m_treeNodeCount);
+    EvaluationBudget::Scope scope(&m_budget);
+    Diagnostics::Scope diagnosticsScope(&m_diagnostics);
+    // an outer profiler (set by the caller) keeps recording when this parser does not profile itself.
+    if(m_profilingEnabled)
+    {
+        m_profiler.clear();
+    }
+    ExecutionProfiler::Scope profilerScope(m_profilingEnabled ? &m_profiler : ExecutionProfiler::current());
+    m_resultsCollected = false;
+    if((m_bytecodeEnabled)&&(m_programs.isEmpty()))
+    {
+        compilePrograms();
+    }
+    const bool streams = (m_parallelEnabled)||(m_randomSeed >= 0);
+    quint32 seed = 0;
+    if(streams)
+    {
+        seed = (m_randomSeed >= 0) ? static_cast<quint32>(m_randomSeed) : std::random_device()();
+    }
+    if((m_parallelEnabled)&&(!m_hasMergeNode)&&(m_startNodes.size() > 1))
+    {
+        startParallel(seed);
+        return;
+    }
+    for(int i = 0; i < m_startNodes.size(); ++i)
+    {
+        if(m_budget.isExhausted())
+        {
+            break;
+        }
+        if(streams)
+        {
+            std::mt19937 generator;
+            seedInstruction(generator,seed,i);
+            Die::RandomScope randomScope(&generator);
+            startInstruction(i);
+        }
+        else
+        {
+            startInstruction(i);
+        }
+    }
+}
+void DiceParser::startInstruction(int index)
+{
+    ExecutionProfiler* profiler = ExecutionProfiler::current();
+    if(nullptr!=profiler)
+    {
+        profiler->setTrack(index);
+    }
+    if(index < m_programs.size())
+    {
+        // the program runs as a whole, it is one event.
+        int event = (nullptr!=profiler) ? profiler->beginEvent(QStringLiteral("DiceVm"),QStringLiteral("DiceVm instruction %1").arg(index)) : -1;
+        m_vms.at(index)->run(m_programs.at(index));
+        if(nullptr!=profiler)
+        {
+            profiler->endEvent(event);
+        }
+    }
+    else
+    {
+        m_startNodes.at(index)->run();
+    }
+}
+void DiceParser::startParallel(quint32 seed)
+{
+    // each instruction has its own budget (sharing live totals), diagnostics and dice stream: they are gathered in order afterward.
+    if(m_budget.isExhausted())
+    {
+        return;
+    }
+    const int count = m_startNodes.size();
+    QVector<EvaluationBudget> budgets = m_budget.split(count);
+    QVector<Diagnostics> diagnostics(count);
+    ExecutionProfiler* profiler = ExecutionProfiler::current();
+    QVector<ExecutionProfiler> profilers(nullptr!=profiler ? count : 0);
+
+    QAtomicInt next(0);
+    auto work = [&]()
+    {
+        for(int i = next.fetchAndAddRelaxed(1); i < count; i = next.fetchAndAddRelaxed(1))
+        {
+            EvaluationBudget::Scope scope(&budgets[i]);
+            Diagnostics::Scope diagnosticsScope(&diagnostics[i]);
+            ExecutionProfiler::Scope profilerScope(nullptr!=profiler ? &profilers[i] : nullptr);
+            std::mt19937 generator;
+            seedInstruction(generator,seed,i);
+            Die::RandomScope randomScope(&generator);
+            startInstruction(i);
+        }
+    };
+    // helpers take the next instruction as soon as they are free, the calling thread works too: it never waits
+    // for a helper which has not started.
+    QThreadPool* pool = s_instructionPool();
+    const int helpers = qMin(count-1,pool->maxThreadCount());
+    QSemaphore finished;
+    for(int i = 0; i < helpers; ++i)
+    {
+        pool->start(new InstructionRunner(work,finished));
+    }
+    work();
+    finished.acquire(helpers);
+
+    for(int i = 0; i < count; ++i)
+    {
+        m_budget.merge(budgets[i]);
+        m_diagnostics.append(diagnostics[i]);
+        if(nullptr!=profiler)
+        {
+            profiler->append(profilers[i]);
+        }
+    }
+    if(m_budget.isExhausted())
+    {
+        // a part may cross a limit with its last charge, after its last check.
+        const QList<Diagnostics::Error>& errors = m_diagnostics.getErrors();
+        auto isBudgetError = [](const Diagnostics::Error& error) { return error.getCode() == ExecutionNode::BUDGET_EXCEEDED; };
+        if(std::none_of(errors.begin(),errors.end(),isBudgetError))
+        {
+            m_diagnostics.addError(ExecutionNode::BUDGET_EXCEEDED,m_budget.getErrorMessage(),QString(),-1,0);
+        }
+    }
+}
+void DiceParser::setParallelEnabled(bool enabled)
+{
+    m_parallelEnabled = enabled;
+}
+bool DiceParser::isParallelEnabled() const
+{
+    return m_parallelEnabled;
+}
+void DiceParser::setRandomSeed(qint64 seed)
+{
+    m_randomSeed = seed;
+}
+qint64 DiceParser::getRandomSeed() const
+{
+    return m_randomSeed;
+}
+void DiceParser::setProfilingEnabled(bool enabled)
+{
+    m_profilingEnabled = enabled;
+}
+bool DiceParser::isProfilingEnabled() const
+{
+    return m_profilingEnabled;
+}
+const ExecutionProfiler* DiceParser::getProfiler() const
+{
+    return &m_profiler;
+}
+void DiceParser::compilePrograms()
+{
+    clearPrograms();
     for(auto start : m_startNodes)
     {
-        start->run();
+        DiceProgram* program = DiceProgram::compile(start);
+        if(nullptr == program)
+        {
+            // nodes like MergeNode read the results of other instructions: all run on the tree.
+            clearPrograms();
+            return;
+        }
+        m_programs.append(program);
+        m_vms.append(new DiceVm());
+    }
+}
+void DiceParser::clearPrograms()
+{
+    qDeleteAll(m_vms);
+    m_vms.clear();
+    qDeleteAll(m_programs);
+    m_programs.clear();
+}
+void DiceParser::setBytecodeEnabled(bool enabled)
+{
+    m_bytecodeEnabled = enabled;
+    if(!enabled)
+    {
+        clearPrograms();
     }
 }
+bool DiceParser::isBytecodeEnabled() const
+{
+    return m_bytecodeEnabled;
+}
+bool DiceParser::hasBytecode() const
+{
+    return !m_programs.isEmpty();
+}
+void DiceParser::simplifyTree()
+{
+    TreeSimplifier simplifier;
+    for(int i = 0; i < m_startNodes.size(); ++i)
+    {
+        m_startNodes[i] = simplifier.fuse(simplifier.simplify(m_startNodes[i]));
+    }
+}
+EvaluationBudget* DiceParser::getBudget()
+{
+    return &m_budget;
+}
 
 QString DiceParser::displayResult()
 {
     QStringList resultList;
-    for(auto start : m_startNodes)
+    for(int index = 0; index < m_startNodes.size(); ++index)
     {
-        ExecutionNode* next = start;
-        int nodeCount=0;
         int resulCount=0;
-        while(nullptr != next->getNextNode() )
-        {
-            next = next->getNextNode();
-            ++nodeCount;
-        }
         //////////////////////////////////
         //
         //  Display
@@ -312,7 +569,7 @@ QString DiceParser::displayResult()
 
         QString str;
         QTextStream stream(&str);
-        Result* result=next->getResult();
+        Result* result=getLeafResult(index);
 
         QString totalValue("you got %1 ;");
         QString dieValue("D%1 : {%2} ");
@@ -323,7 +580,7 @@ QString DiceParser::displayResult()
             ++resulCount;
             if((result->hasResultOfType(Result::SCALAR))&&(!scalarDone))
             {
-                stream << totalValue.arg(result->getResult(Result::SCALAR).toReal()) << endl; //.arg(m_command)
+                stream << totalValue.arg(result->scalar()) << '\n';
                 scalarDone=true;
             }
             else if(result->hasResultOfType(Result::DICE_LIST))
@@ -335,7 +592,7 @@ QString DiceParser::displayResult()
 
                     QString resulStr;
                     quint64 face=0;
-                    for(Die* die : myDiceResult->getResultList())
+                    for(Die* die : myDiceResult->getDiceList())
                     {
                         if(!die->hasBeenDisplayed())
                         {
@@ -368,38 +625,66 @@ QString DiceParser::displayResult()
             }
             else if(result->hasResultOfType(Result::STRING))
             {
-                stream << result->getResult(Result::STRING).toString();
+                stream << result->text();
             }
 
             result = result->getPrevious();
         }
 
-        QTextStream out(stdout);
-        out << str << "you rolled: " <<m_command << endl;
-        out <<  endl;
-
-
         resultList << QStringLiteral("%1, you rolled:%3").arg(str.simplified()).arg(m_command) ;
     }
 
     return resultList.join('\n');
 }
+void DiceParser::collectResults()
+{
+    m_resultSummaries.clear();
+    for(int i = 0; i < m_startNodes.size(); ++i)
+    {
+        ResultSummary summary;
+        summary.collect(getLeafResult(i));
+        m_resultSummaries.append(summary);
+    }
+    m_resultsCollected = true;
+}
+const QList<ResultSummary>& DiceParser::getResultSummaries()
+{
+    if(!m_resultsCollected)
+    {
+        collectResults();
+    }
+    return m_resultSummaries;
+}
+void DiceParser::visitDice(DiceVisitor& visitor)
+{
+    int index = 0;
+    for(const ResultSummary& summary : getResultSummaries())
+    {
+        visitor.beginInstruction(index);
+        summary.visitDice(visitor);
+        visitor.endInstruction(index);
+        ++index;
+    }
+}
+bool DiceParser::hasHomogeneousDice()
+{
+    for(const ResultSummary& summary : getResultSummaries())
+    {
+        if(!summary.isHomogeneous())
+        {
+            return false;
+        }
+    }
+    return true;
+}
 QList<qreal> DiceParser::getLastIntegerResults()
 {
     QList<qreal> resultValues;
-    for(auto node : m_startNodes)
+    for(const ResultSummary& summary : getResultSummaries())
     {
-        ExecutionNode* next = getLeafNode(node);
-        Result* result=next->getResult();
-        bool scalarDone = false;
-        while((result!=nullptr)&&(!scalarDone))
+        if(summary.hasScalar())
         {
-            if(result->hasResultOfType(Result::SCALAR))
-            {
-                resultValues << result->getResult(Result::SCALAR).toReal();
-                scalarDone=true;
-            }
-            result=result->getPrevious();
+            resultValues << summary.getScalar();
         }
     }
     return resultValues;
@@ -407,46 +692,21 @@ QList<qreal> DiceParser::getLastIntegerResults()
 QStringList DiceParser::getStringResult( )
 {
     QStringList stringListResult;
-    for(auto node : m_startNodes)
+    for(const ResultSummary& summary : getResultSummaries())
     {
-        ExecutionNode* next = getLeafNode(node);
-        QString str;
-        Result* result=next->getResult();
-        bool found = false;
-        while((nullptr!=result) && (!found) )
-        {
-            if(result->hasResultOfType(Result::STRING))
-            {
-                str = result->getResult(Result::STRING).toString();
-                found = true;
-            }
-            result = result->getPrevious();
-        }
-        stringListResult << str;
+        stringListResult << summary.getString();
     }
     return stringListResult;
 }
 QStringList DiceParser::getAllStringResult(bool& hasAlias)
 {
-    //QStringList allResult;
     QStringList stringListResult;
-    for(auto node : m_startNodes)
+    for(const ResultSummary& summary : getResultSummaries())
     {
-        ExecutionNode* next = getLeafNode(node);
-        Result* result=next->getResult();
-
-        while(nullptr!=result)
+        if(!summary.getAllStrings().isEmpty())
         {
-            if(result->hasResultOfType(Result::STRING))
-            {
-                StringResult* stringResult = dynamic_cast<StringResult*>(result);
-                if(nullptr!=stringResult)
-                {
-                    stringListResult << stringResult->getText();
-                    hasAlias = stringResult->hasHighLight();
-                }
-            }
-            result = result->getPrevious();
+            stringListResult << summary.getAllStrings();
+            hasAlias = summary.isStringHighlighted();
         }
     }
     return stringListResult;
@@ -454,108 +714,25 @@ QStringList DiceParser::getAllStringResult(bool& hasAlias)
 QStringList DiceParser::getAllDiceResult(bool& hasAlias)
 {
     QStringList stringListResult;
-    for(auto node : m_startNodes)
+    for(const ResultSummary& summary : getResultSummaries())
     {
-        ExecutionNode* next = getLeafNode(node);
-        Result* result=next->getResult();
-        QList<Die*> dieListResult;
-
-        while(nullptr!=result)
+        if(summary.hasDiceList())
         {
-            if(result->hasResultOfType(Result::DICE_LIST))
-            {
-                DiceResult* stringResult = dynamic_cast<DiceResult*>(result);
-                if(nullptr!=stringResult)
-                {
-                    for(auto die : stringResult->getResultList())
-                    {
-                        if(!dieListResult.contains(die))
-                        {
-                            dieListResult.removeAll(die);
-                            dieListResult << die;
-                        }
-                    }
-                    hasAlias = true;
-                }
-            }
-            result = result->getPrevious();
-        }
-        for(Die* die : dieListResult)
-        {
-            if(die->isHighlighted())
-            {
-                for(qint64 value : die->getListValue())
-                {
-
-                    stringListResult << QString::number(value);
-                }
-            }
+            hasAlias = true;
         }
+        stringListResult << summary.getHighlightedDiceValues();
     }
-
     return stringListResult;
 }
 void DiceParser::getLastDiceResult(QList<ExportedDiceResult>& diceValuesList,bool& homogeneous)
 {
-    for(auto start : m_startNodes)
+    for(const ResultSummary& summary : getResultSummaries())
     {
-        ExportedDiceResult diceValues;
-        ExecutionNode* next = getLeafNode(start);
-        Result* result=next->getResult();
-
-        while(nullptr!=result)
+        if(homogeneous)
         {
-            if(result->hasResultOfType(Result::DICE_LIST))
-            {
-                DiceResult* diceResult = dynamic_cast<DiceResult*>(result);
-                if(nullptr!=diceResult)
-                {
-                    if(homogeneous)
-                    {
-
-                        homogeneous = diceResult->isHomogeneous();
-                    }
-                    quint64 face=0;
-                    ListDiceResult listpair;
-                    for(Die* die : diceResult->getResultList())
-                    {
-                        if(!die->hasBeenDisplayed())
-                        {
-                            QList<quint64> valuesResult;
-                            valuesResult.append(die->getValue());
-                            die->displayed();
-                            face = die->getFaces();
-                            if(die->hasChildrenValue())
-                            {
-                                for(qint64 i : die->getListValue())
-                                {
-                                    valuesResult.append(i);
-                                }
-                            }
-                            HighLightDice hlDice(valuesResult,die->isHighlighted(),die->getColor());
-                            //QPair<QList<quint64>,bool> pair(valuesResult,die->isHighlighted());
-                            listpair.append(hlDice);
-                        }
-                    }
-                    if(!listpair.isEmpty())
-                    {
-                        if(!diceValues.contains(face))
-                        {
-                            diceValues.insert(face,listpair);
-                        }
-                        else
-                        {
-                            ListDiceResult tmp = diceValues.value(face);
-                            tmp.append(listpair);
-                            diceValues.insert(face,tmp);
-                        }
-
-                    }
-                }
-            }
-            result = result->getPrevious();
+            homogeneous = summary.isHomogeneous();
         }
-        diceValuesList.append(diceValues);
+        diceValuesList.append(summary.getExportedDice());
     }
 }
 QString DiceParser::getDiceCommand() const
@@ -565,73 +742,38 @@ QString DiceParser::getDiceCommand() const
 
 bool DiceParser::hasIntegerResultNotInFirst()
 {
-    bool result;
-    for(auto node : m_startNodes)
+    bool result = false;
+    for(const ResultSummary& summary : getResultSummaries())
     {
-        result |= hasResultOfType(Result::SCALAR,node);
+        result |= summary.hasScalar();
     }
     return result;
 }
 
 bool DiceParser::hasDiceResult()
 {
-    bool result;
-    for(auto node : m_startNodes)
+    bool result = false;
+    for(const ResultSummary& summary : getResultSummaries())
     {
-        result |= hasResultOfType(Result::DICE_LIST,node);
+        result |= summary.hasDiceList();
     }
     return result;
 }
 bool DiceParser::hasStringResult()
 {
-    bool result;
-    for(auto node : m_startNodes)
+    bool result = false;
+    for(const ResultSummary& summary : getResultSummaries())
     {
-        result |= hasResultOfType(Result::STRING,node);
+        result |= summary.hasString();
     }
     return result;
 }
-bool DiceParser::hasResultOfType(Result::RESULT_TYPE type, ExecutionNode* node, bool notthelast)
-{
-    bool scalarDone = false;
-    ExecutionNode* next = getLeafNode(node);
-    Result* result=next->getResult();
-    while((result!=nullptr)&&(!scalarDone))
-    {
-        if(result->hasResultOfType(type) && ((!notthelast)||(notthelast && (nullptr!=result->getPrevious()))))
-        {
-            scalarDone=true;
-        }
-        result=result->getPrevious();
-    }
-    return scalarDone;
-}
 QList<qreal> DiceParser::getSumOfDiceResult()
 {
     QList<qreal> resultValues;
-    for(auto node : m_startNodes)
+    for(const ResultSummary& summary : getResultSummaries())
     {
-        qreal resultValue=0;
-        ExecutionNode* next = getLeafNode(node);
-        Result* result=next->getResult();
-        bool found = false;
-        while((nullptr!=result)&&(!found))
-        {
-            if(result->hasResultOfType(Result::DICE_LIST))
-            {
-                DiceResult* myDiceResult = dynamic_cast<DiceResult*>(result);
-                if(nullptr!=myDiceResult)
-                {
-                    for(Die* die : myDiceResult->getResultList())
-                    {
-                        resultValue+=die->getValue();
-                    }
-                    found = true;
-                }
-            }
-            result = result->getPrevious();
-        }
-        resultValues << resultValue;
+        resultValues << summary.getDiceSum();
     }
     return resultValues;
 }
@@ -648,10 +790,19 @@ ExecutionNode* DiceParser::getLeafNode(ExecutionNode* start)
     }
     return next;
 }
+Result* DiceParser::getLeafResult(int index)
+{
+    if(index < m_programs.size())
+    {
+        return m_vms.at(index)->getLeafResult();
+    }
+    return getLeafNode(m_startNodes.at(index))->getResult();
+}
 
 bool DiceParser::readDice(QString&  str,ExecutionNode* & node)
 {
     DiceOperator currentOperator;
+    const int start = m_diagnostics.getCursor();
 
     if(readDiceOperator(str,currentOperator))
     {
@@ -666,10 +817,11 @@ bool DiceParser::readDice(QString&  str,ExecutionNode* & node)
             {
                 if(max<1)
                 {
-                    m_errorMap.insert(ExecutionNode::BAD_SYNTAXE,QObject::tr("Dice with %1 face(s) does not exist. Please, put a value higher than 0").arg(max));
+                    addParsingError(ExecutionNode::BAD_SYNTAXE,QObject::tr("Dice with %1 face(s) does not exist. Please, put a value higher than 0").arg(max));
                     return false;
                 }
                 DiceRollerNode* drNode = new DiceRollerNode(max);
+                setSourceSpan(drNode,start);
                 if(hasOp)
                 {
                     drNode->setOperator(op);
@@ -688,6 +840,7 @@ bool DiceParser::readDice(QString&  str,ExecutionNode* & node)
                 // qint64 face = abs(num - end);
                 //qDebug() << face << end;
                 DiceRollerNode* drNode = new DiceRollerNode(max,min);
+                setSourceSpan(drNode,start);
 
                 if(hasOp)
                 {
@@ -710,6 +863,7 @@ bool DiceParser::readDice(QString&  str,ExecutionNode* & node)
             if(m_parsingToolbox->readList(str,list,listRange))
             {
                 ListSetRollNode* lsrNode = new ListSetRollNode();
+                setSourceSpan(lsrNode,start);
                 lsrNode->setRangeList(listRange);
                 if(op == ParsingToolBox::UNIQUE)
                 {
@@ -721,7 +875,7 @@ bool DiceParser::readDice(QString&  str,ExecutionNode* & node)
             }
             else
             {
-                m_errorMap.insert(ExecutionNode::BAD_SYNTAXE,QObject::tr("List is missing after the L operator. Please, add it (e.g : 1L[sword,spear,gun,arrow])"));
+                addParsingError(ExecutionNode::BAD_SYNTAXE,QObject::tr("List is missing after the L operator. Please, add it (e.g : 1L[sword,spear,gun,arrow])"));
             }
         }
 
@@ -762,6 +916,10 @@ bool DiceParser::readCommand(QString& str,ExecutionNode* & node)
         {
             node = new ListAliasNode(m_aliasList);
         }
+        if(nullptr!=node)
+        {
+            node->setSourceSpan(m_diagnostics.getCursor(),str.size());
+        }
         return true;
     }
     return false;
@@ -809,10 +967,12 @@ bool DiceParser::readOperator(QString& str,ExecutionNode* previous)
     }
 
     Die::ArithmeticOperator op;
+    const int start = m_diagnostics.getCursor();
     if(m_parsingToolbox->readArithmeticOperator(str,op))
     {
         ScalarOperatorNode* node = new ScalarOperatorNode();
         node->setArithmeticOperator(op);
+        setSourceSpan(node,start);
         ExecutionNode* nodeExec = nullptr;
         if(readExpression(str,nodeExec))
         {
@@ -912,6 +1072,8 @@ bool DiceParser::readOption(QString& str,ExecutionNode* previous)//,
 
     ExecutionNode* node = nullptr;
     bool found=false;
+    // each option node spans from its key to the end of its parameters.
+    const int start = m_diagnostics.getCursor();
 
     for(int i = 0; ((i<m_OptionOp->keys().size())&&(!found));++i )
     {
@@ -925,20 +1087,18 @@ bool DiceParser::readOption(QString& str,ExecutionNode* previous)//,
             {
             case Keep:
             {
-                qDebug() << "keep " << previous->toString(true) << str;
-                if(str == "4+7")
-                {
-                    qDebug() << "nauteanuit";
-                }
+                DICE_DEBUG(PARSER) << "keep" << previous->toString(true) << str;
                 qint64 myNumber=0;
                 bool ascending = m_parsingToolbox->readAscending(str);
 
                 if(m_parsingToolbox->readNumber(str,myNumber))
                 {
                     node = m_parsingToolbox->addSort(previous,ascending);
+                    setSourceSpan(node,start);
                     KeepDiceExecNode* nodeK = new KeepDiceExecNode();
-                    qDebug() << "nodeK " << previous->toString(true)  << str;
+                    DICE_DEBUG(PARSER) << "nodeK" << previous->toString(true) << str;
                     nodeK->setDiceKeepNumber(myNumber);
+                    setSourceSpan(nodeK,start);
                     node->setNextNode(nodeK);
                     node = nodeK;
                     found = true;
@@ -960,12 +1120,15 @@ bool DiceParser::readOption(QString& str,ExecutionNode* previous)//,
                     {
 
                         previous = addExploseDiceNode(nodeTmp->getFaces(),previous);
+                        setSourceSpan(previous,start);
                     }
 
                     node = m_parsingToolbox->addSort(previous,ascending);
+                    setSourceSpan(node,start);
 
                     KeepDiceExecNode* nodeK = new KeepDiceExecNode();
                     nodeK->setDiceKeepNumber(myNumber);
+                    setSourceSpan(nodeK,start);
 
                     node->setNextNode(nodeK);
                     node = nodeK;
@@ -982,6 +1145,7 @@ bool DiceParser::readOption(QString& str,ExecutionNode* previous)//,
 
                     FilterNode* filterNode = new FilterNode();
                     filterNode->setValidator(validator);
+                    setSourceSpan(filterNode,start);
 
                     previous->setNextNode(filterNode);
                     node = filterNode;
@@ -993,9 +1157,10 @@ bool DiceParser::readOption(QString& str,ExecutionNode* previous)//,
             {
                 bool ascending = m_parsingToolbox->readAscending(str);
                 node = m_parsingToolbox->addSort(previous,ascending);
+                setSourceSpan(node,start);
                 /*if(!hasDice)
                 {
-                    m_errorMap.insert(ExecutionNode::BAD_SYNTAXE,QObject::tr("Sort Operator does not support default dice. You should add dice command before the s"));
+                    addParsingError(ExecutionNode::BAD_SYNTAXE,QObject::tr("Sort Operator does not support default dice. You should add dice command before the s"));
                 }*/
                 found = true;
             }
@@ -1009,6 +1174,7 @@ bool DiceParser::readOption(QString& str,ExecutionNode* previous)//,
 
                     CountExecuteNode* countNode = new CountExecuteNode();
                     countNode->setValidator(validator);
+                    setSourceSpan(countNode,start);
 
                     previous->setNextNode(countNode);
                     node = countNode;
@@ -1016,7 +1182,7 @@ bool DiceParser::readOption(QString& str,ExecutionNode* previous)//,
                 }
                 else
                 {
-                    m_errorMap.insert(ExecutionNode::BAD_SYNTAXE,QObject::tr("Validator is missing after the c operator. Please, change it"));
+                    addParsingError(ExecutionNode::BAD_SYNTAXE,QObject::tr("Validator is missing after the c operator. Please, change it"));
                 }
             }
                 break;
@@ -1033,13 +1199,14 @@ bool DiceParser::readOption(QString& str,ExecutionNode* previous)//,
                         rerollNode->setAddingMode(true);
                     }
                     rerollNode->setValidator(validator);
+                    setSourceSpan(rerollNode,start);
                     previous->setNextNode(rerollNode);
                     node = rerollNode;
                     found = true;
                 }
                 else
                 {
-                    m_errorMap.insert(ExecutionNode::BAD_SYNTAXE,QObject::tr("Validator is missing after the %1 operator. Please, change it").arg(m_OptionOp->value(tmp)==Reroll?QStringLiteral("r"):QStringLiteral("a")));
+                    addParsingError(ExecutionNode::BAD_SYNTAXE,QObject::tr("Validator is missing after the %1 operator. Please, change it").arg(m_OptionOp->value(tmp)==Reroll?QStringLiteral("r"):QStringLiteral("a")));
                 }
 
             }
@@ -1051,10 +1218,11 @@ bool DiceParser::readOption(QString& str,ExecutionNode* previous)//,
                 {
                     if(!m_parsingToolbox->isValidValidator(previous,validator))
                     {
-                        m_errorMap.insert(ExecutionNode::ENDLESS_LOOP_ERROR,QObject::tr("This condition %1 introduces an endless loop. Please, change it").arg(validator->toString()));
+                        addParsingError(ExecutionNode::ENDLESS_LOOP_ERROR,QObject::tr("This condition %1 introduces an endless loop. Please, change it").arg(validator->toString()));
                     }
                     ExploseDiceNode* explosedNode = new ExploseDiceNode();
                     explosedNode->setValidator(validator);
+                    setSourceSpan(explosedNode,start);
                     previous->setNextNode(explosedNode);
                     node = explosedNode;
                     found = true;
@@ -1062,7 +1230,7 @@ bool DiceParser::readOption(QString& str,ExecutionNode* previous)//,
                 }
                 else
                 {
-                    m_errorMap.insert(ExecutionNode::BAD_SYNTAXE,QObject::tr("Validator is missing after the e operator. Please, change it"));
+                    addParsingError(ExecutionNode::BAD_SYNTAXE,QObject::tr("Validator is missing after the e operator. Please, change it"));
                 }
             }
                 break;
@@ -1070,6 +1238,8 @@ bool DiceParser::readOption(QString& str,ExecutionNode* previous)//,
             {
                 MergeNode* mergeNode = new MergeNode();
                 mergeNode->setStartList(&m_startNodes);
+                setSourceSpan(mergeNode,start);
+                m_hasMergeNode = true;
                 previous->setNextNode(mergeNode);
                 node = mergeNode;
                 found = true;
@@ -1080,6 +1250,7 @@ bool DiceParser::readOption(QString& str,ExecutionNode* previous)//,
             {
                 PainterNode* painter = new PainterNode();
                 m_parsingToolbox->readPainterParameter(painter,str);
+                setSourceSpan(painter,start);
                 previous->setNextNode(painter);
                 node = painter;
                 found = true;
@@ -1092,6 +1263,8 @@ bool DiceParser::readOption(QString& str,ExecutionNode* previous)//,
                 Validator* validator = m_parsingToolbox->readCompositeValidator(str);
                 if(nullptr!=validator)
                 {
+                    // the branches have their own spans.
+                    setSourceSpan(nodeif,start);
                     ExecutionNode* trueNode = nullptr;
                     ExecutionNode* falseNode = nullptr;
                     if(readIfInstruction(str,trueNode,falseNode))
@@ -1117,6 +1290,7 @@ bool DiceParser::readOption(QString& str,ExecutionNode* previous)//,
             case Split:
             {
                 SplitNode* splitnode = new SplitNode();
+                setSourceSpan(splitnode,start);
                 previous->setNextNode(splitnode);
                 node = splitnode;
                 found = true;
@@ -1129,6 +1303,7 @@ bool DiceParser::readOption(QString& str,ExecutionNode* previous)//,
                 {
                     GroupNode* groupNode = new GroupNode();
                     groupNode->setGroupValue(groupNumber);
+                    setSourceSpan(groupNode,start);
                     previous->setNextNode(groupNode);
                     node = groupNode;
                     found = true;
@@ -1161,10 +1336,12 @@ bool DiceParser::readBlocInstruction(QString& str,ExecutionNode*& resultnode)
         ExecutionNode* node;
         Die::ArithmeticOperator op;
         ScalarOperatorNode* scalarNode = nullptr;
+        const int start = m_diagnostics.getCursor();
         if(m_parsingToolbox->readArithmeticOperator(str,op))
         {
             scalarNode = new ScalarOperatorNode();
             scalarNode->setArithmeticOperator(op);
+            setSourceSpan(scalarNode,start);
         }
         if(readExpression(str,node))
         {
@@ -1199,17 +1376,24 @@ void DiceParser::setComment(const QString &comment)
 
 QMap<ExecutionNode::DICE_ERROR_CODE,QString> DiceParser::getErrorMap()
 {
-    QMap<ExecutionNode::DICE_ERROR_CODE,QString> map;
-
-    for(auto start : m_startNodes)
-    {
-        auto mapTmp = start->getExecutionErrorMap();
-        for(auto key : mapTmp.keys())
-        {
-            map.insertMulti(key,mapTmp[key]);
-        }
-    }
-    return map;
+    return m_diagnostics.getExecutionErrorMap();
+}
+bool DiceParser::hasExecutionError() const
+{
+    return m_diagnostics.hasError();
+}
+const Diagnostics* DiceParser::getDiagnostics() const
+{
+    return &m_diagnostics;
+}
+void DiceParser::setSourceSpan(ExecutionNode* node,int start)
+{
+    node->setSourceSpan(start,m_diagnostics.getCursor()-start);
+}
+void DiceParser::addParsingError(ExecutionNode::DICE_ERROR_CODE code,const QString& message)
+{
+    m_errorMap.insert(code,message);
+    m_diagnostics.addParsingError(code,message);
 }
 QString DiceParser::humanReadableError()
 {
@@ -1237,10 +1421,12 @@ bool DiceParser::readOperand(QString& str,ExecutionNode* & node)
 {
     qint64 myNumber=1;
     QString resultStr;
+    const int start = m_diagnostics.getCursor();
     if(m_parsingToolbox->readNumber(str,myNumber))
     {
         NumberNode* numberNode = new NumberNode();
         numberNode->setNumber(myNumber);
+        setSourceSpan(numberNode,start);
 
         node = numberNode;
         return true;
@@ -1249,6 +1435,7 @@ bool DiceParser::readOperand(QString& str,ExecutionNode* & node)
     {
         StringNode* strNode = new StringNode();
         strNode->setString(resultStr);
+        setSourceSpan(strNode,start);
         node = strNode;
         return true;
     }
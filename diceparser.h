@@ -34,9 +34,13 @@
 #include "parsingtoolbox.h"
 #include "dicealias.h"
 #include "highlightdice.h"
+#include "evaluationbudget.h"
+#include "diagnostics.h"
+#include "resultsummary.h"
+#include "diceprogram.h"
+#include "dicevm.h"
+#include "executionprofiler.h"
 
-typedef QList<HighLightDice > ListDiceResult;
-typedef QMap<int,ListDiceResult > ExportedDiceResult;
 
 class ExploseDiceNode;
 /**
@@ -114,7 +118,8 @@ public:
     void Start();
 
     /**
-     * @brief displayResult
+     * @brief displayResult builds a summary of the last run, nothing is written to the standard output.
+     * @return one line for each instruction, see DiceFormatter to get the dice only.
      */
     QString displayResult();
     /**
@@ -128,6 +133,26 @@ public:
      * @brief displayDotTree
      */
     void writeDownDotTree(QString filepath);
+    /**
+     * @brief collectResults walks the results of each instruction once, getters are then served from this summary.
+     * It is done on demand after each run, call it again only if results have been changed since.
+     */
+    void collectResults();
+    /**
+     * @brief getResultSummaries
+     * @return one summary for each instruction of the command.
+     */
+    const QList<ResultSummary>& getResultSummaries();
+    /**
+     * @brief visitDice streams the dice to display to the visitor, without building ExportedDiceResult.
+     * @param visitor
+     */
+    void visitDice(DiceVisitor& visitor);
+    /**
+     * @brief hasHomogeneousDice
+     * @return false if one result mixes several kinds of dice.
+     */
+    bool hasHomogeneousDice();
     /**
      * @brief getLastIntegerResults
      * @return
@@ -193,6 +218,16 @@ public:
      * @return
      */
     QMap<ExecutionNode::DICE_ERROR_CODE,QString> getErrorMap();
+    /**
+     * @brief hasExecutionError
+     * @return true if the last run has raised an error, without walking the tree.
+     */
+    bool hasExecutionError() const;
+    /**
+     * @brief getDiagnostics gives every error of the current command with its node and its source span.
+     * @return the diagnostics, cleared at each parseLine.
+     */
+    const Diagnostics* getDiagnostics() const;
     /**
      * @brief setPathToHelp set the path to the documentation, this path must be adatped to the lang of application etc…
      * @param l the path.
@@ -227,6 +262,67 @@ public:
      * @param variables
      */
     void setVariableDictionary(QHash<QString,QString>* variables);
+    /**
+     * @brief getBudget gives access to the limits applied to each command (dice, rolls, nodes, time and memory).
+     * @return the budget, reset at each parseLine and Start.
+     */
+    EvaluationBudget* getBudget();
+    /**
+     * @brief setBytecodeEnabled runs the next commands on DiceVm when all their instructions compile, see DiceProgram.
+     * Only numbers, dice rolls (D), reroll, explode, sort, keep, filter, count, @, scalar operators and parentheses
+     * are lowered. A command using any other node, such as the if operator (i), lists (L), merge, paint or group,
+     * keeps running on the execution tree even when bytecode is enabled.
+     * @param enabled
+     */
+    void setBytecodeEnabled(bool enabled);
+    /**
+     * @brief isBytecodeEnabled
+     * @return
+     */
+    bool isBytecodeEnabled() const;
+    /**
+     * @brief hasBytecode
+     * @return true if the last Start() ran the command on DiceVm.
+     */
+    bool hasBytecode() const;
+    /**
+     * @brief setParallelEnabled runs the instructions of a command (separated by ;) on a thread pool.
+     * Commands using the merge operator stay sequential. Each instruction has its own dice stream (see setRandomSeed)
+     * and a part of the remaining budget: limits are checked on the totals once all instructions have run.
+     * @param enabled
+     */
+    void setParallelEnabled(bool enabled);
+    /**
+     * @brief isParallelEnabled
+     * @return
+     */
+    bool isParallelEnabled() const;
+    /**
+     * @brief setRandomSeed sets the seed of the dice streams of the instructions, a command then always gives the same
+     * results, run in parallel or not.
+     * @param seed -1 draws a new seed at each Start(), dice are then only on streams in parallel mode.
+     */
+    void setRandomSeed(qint64 seed);
+    /**
+     * @brief getRandomSeed
+     * @return
+     */
+    qint64 getRandomSeed() const;
+    /**
+     * @brief setProfilingEnabled records the time, dice and memory of each node during the next Start().
+     * @param enabled
+     */
+    void setProfilingEnabled(bool enabled);
+    /**
+     * @brief isProfilingEnabled
+     * @return
+     */
+    bool isProfilingEnabled() const;
+    /**
+     * @brief getProfiler
+     * @return events of the last Start() when profiling is enabled, see ExecutionProfiler::toChromeTrace().
+     */
+    const ExecutionProfiler* getProfiler() const;
     QString getComment() const;
     void setComment(const QString &comment);
 
@@ -238,6 +334,10 @@ private:
      * @return
      */
     bool readDice(QString&  str,ExecutionNode* & node);
+    /**
+     * @brief simplifyTree folds the constant parts of each instruction and fuses the common ones, see TreeSimplifier.
+     */
+    void simplifyTree();
     /**
      * @brief readDiceOperator
      * @return
@@ -311,13 +411,40 @@ private:
      * @return
      */
     ExecutionNode* getLeafNode(ExecutionNode* node);
+    /**
+     * @brief getLeafResult
+     * @param index of the instruction.
+     * @return result of the leaf node, or of the last bytecode instruction when the command ran on DiceVm.
+     */
+    Result* getLeafResult(int index);
+    /**
+     * @brief compilePrograms compiles every instruction, or none if one of them is not supported.
+     */
+    void compilePrograms();
+    void clearPrograms();
+    /**
+     * @brief startInstruction runs one instruction, on DiceVm or on the tree.
+     * @param index
+     */
+    void startInstruction(int index);
+    /**
+     * @brief startParallel runs all instructions on the thread pool and gathers their budgets and errors in order.
+     * @param seed
+     */
+    void startParallel(quint32 seed);
 
     /**
-     * @brief hasResultOfType
-     * @param notthelast
-     * @return
+     * @brief setSourceSpan gives a node the text read from start to the parse cursor, called where its token is read.
+     * @param node
+     * @param start index in the command where the token begins.
+     */
+    void setSourceSpan(ExecutionNode* node,int start);
+    /**
+     * @brief addParsingError
+     * @param code
+     * @param message
      */
-    bool hasResultOfType(Result::RESULT_TYPE, ExecutionNode* node, bool notthelast = false);
+    void addParsingError(ExecutionNode::DICE_ERROR_CODE code,const QString& message);
 
 
 private:
@@ -340,6 +467,19 @@ private:
     bool m_currentTreeHasSeparator;
     bool readBlocInstruction(QString &str, ExecutionNode *&resultnode);
     QString m_comment;
+    EvaluationBudget m_budget;
+    qint64 m_treeNodeCount = 0;
+    Diagnostics m_diagnostics;
+    QList<ResultSummary> m_resultSummaries;
+    bool m_resultsCollected;
+    bool m_bytecodeEnabled = false;
+    QList<DiceProgram*> m_programs;
+    QList<DiceVm*> m_vms;
+    bool m_parallelEnabled = false;
+    bool m_hasMergeNode = false;
+    qint64 m_randomSeed = -1;
+    bool m_profilingEnabled = false;
+    ExecutionProfiler m_profiler;
 };
 
 #endif // DICEPARSER_H
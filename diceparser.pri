@@ -5,11 +5,22 @@ INCLUDEPATH += $$PWD
 
 SOURCES += $$PWD/diceparser.cpp \
     $$PWD/result/diceresult.cpp \
+    $$PWD/result/dicehistogram.cpp \
     $$PWD/range.cpp \
     $$PWD/highlightdice.cpp \
+    $$PWD/resultsummary.cpp \
+    $$PWD/dicevisitor.cpp \
+    $$PWD/diceformatter.cpp \
+    $$PWD/treesimplifier.cpp \
+    $$PWD/diceprogram.cpp \
+    $$PWD/dicevm.cpp \
+    $$PWD/bytecodechecker.cpp \
+    $$PWD/executionprofiler.cpp \
     $$PWD/booleancondition.cpp \
     $$PWD/validator.cpp \
     $$PWD/die.cpp \
+    $$PWD/evaluationbudget.cpp \
+    $$PWD/diagnostics.cpp \
     $$PWD/result/result.cpp \
     $$PWD/result/scalarresult.cpp \
     $$PWD/parsingtoolbox.cpp \
@@ -25,11 +36,23 @@ SOURCES += $$PWD/diceparser.cpp \
 HEADERS += \
     $$PWD/diceparser.h \
     $$PWD/result/diceresult.h \
+    $$PWD/result/dicehistogram.h \
     $$PWD/range.h \
     $$PWD/booleancondition.h \
     $$PWD/highlightdice.h \
+    $$PWD/resultsummary.h \
+    $$PWD/dicevisitor.h \
+    $$PWD/diceformatter.h \
+    $$PWD/treesimplifier.h \
+    $$PWD/diceprogram.h \
+    $$PWD/dicevm.h \
+    $$PWD/bytecodechecker.h \
+    $$PWD/executionprofiler.h \
+    $$PWD/dicelog.h \
     $$PWD/validator.h \
     $$PWD/die.h \
+    $$PWD/evaluationbudget.h \
+    $$PWD/diagnostics.h \
     $$PWD/result/result.h \
     $$PWD/result/scalarresult.h \
     $$PWD/parsingtoolbox.h \
@@ -52,6 +75,7 @@ HEADERS += \
     $$PWD/node/sortresult.h \
     $$PWD/node/keepdiceexecnode.h \
     $$PWD/node/countexecutenode.h \
+    $$PWD/node/fusedrollnode.h \
     $$PWD/node/explosedicenode.h \
     $$PWD/node/parenthesesnode.h \
     $$PWD/node/helpnode.h \
@@ -73,6 +97,7 @@ SOURCES += \
     $$PWD/node/sortresult.cpp \
     $$PWD/node/keepdiceexecnode.cpp \
     $$PWD/node/countexecutenode.cpp \
+    $$PWD/node/fusedrollnode.cpp \
     $$PWD/node/explosedicenode.cpp \
     $$PWD/node/parenthesesnode.cpp \
     $$PWD/node/helpnode.cpp \
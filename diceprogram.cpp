@@ -0,0 +1,533 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include "diceprogram.h"
+
+#include "booleancondition.h"
+#include "compositevalidator.h"
+#include "operationcondition.h"
+#include "range.h"
+
+#include "node/startingnode.h"
+#include "node/numbernode.h"
+#include "node/dicerollernode.h"
+#include "node/rerolldicenode.h"
+#include "node/explosedicenode.h"
+#include "node/sortresult.h"
+#include "node/keepdiceexecnode.h"
+#include "node/filternode.h"
+#include "node/countexecutenode.h"
+#include "node/jumpbackwardnode.h"
+#include "node/scalaroperatornode.h"
+#include "node/parenthesesnode.h"
+#include "node/fusedrollnode.h"
+
+#define PROGRAM_MAGIC "DPB1"
+#define MAX_VALIDATORS 32767
+#define MAX_VALIDATOR_DEPTH 16
+
+namespace
+{
+enum ValidatorType : quint8 {BOOLEAN_CONDITION,RANGE,OPERATION_CONDITION,COMPOSITE_VALIDATOR};
+
+template <typename T>
+void writeValue(QByteArray& out,T value)
+{
+    quint64 bits = static_cast<quint64>(value);
+    for(std::size_t i = 0; i < sizeof(T); ++i)
+    {
+        out.append(static_cast<char>((bits >> (8*i)) & 0xFF));
+    }
+}
+
+/**
+ * @brief The Reader class reads values written by writeValue, any read past the end makes it invalid.
+ */
+class Reader
+{
+public:
+    explicit Reader(const QByteArray& data)
+        : m_data(data),m_position(0),m_valid(true)
+    {
+    }
+    template <typename T>
+    T read()
+    {
+        if(m_position+static_cast<int>(sizeof(T)) > m_data.size())
+        {
+            m_valid = false;
+            return T();
+        }
+        quint64 bits = 0;
+        for(std::size_t i = 0; i < sizeof(T); ++i)
+        {
+            bits |= static_cast<quint64>(static_cast<quint8>(m_data.at(m_position++))) << (8*i);
+        }
+        return static_cast<T>(bits);
+    }
+    bool isValid() const
+    {
+        return m_valid;
+    }
+    void invalidate()
+    {
+        m_valid = false;
+    }
+    bool atEnd() const
+    {
+        return m_position == m_data.size();
+    }
+private:
+    const QByteArray& m_data;
+    int m_position;
+    bool m_valid;
+};
+
+bool writeValidator(QByteArray& out,const Validator* validator)
+{
+    if(const BooleanCondition* condition = dynamic_cast<const BooleanCondition*>(validator))
+    {
+        writeValue<quint8>(out,BOOLEAN_CONDITION);
+        writeValue<quint8>(out,condition->getOperator());
+        writeValue<qint64>(out,condition->getValue());
+        return true;
+    }
+    if(const Range* range = dynamic_cast<const Range*>(validator))
+    {
+        writeValue<quint8>(out,RANGE);
+        writeValue<quint8>(out,(range->hasStart() ? 1 : 0)|(range->hasEnd() ? 2 : 0)|(range->isEmptyRange() ? 4 : 0));
+        writeValue<qint64>(out,range->hasStart() ? range->getStart() : 0);
+        writeValue<qint64>(out,range->hasEnd() ? range->getEnd() : 0);
+        return true;
+    }
+    if(const OperationCondition* operation = dynamic_cast<const OperationCondition*>(validator))
+    {
+        writeValue<quint8>(out,OPERATION_CONDITION);
+        writeValue<quint8>(out,operation->getOperator());
+        writeValue<qint64>(out,operation->getValue());
+        return writeValidator(out,operation->getBoolean());
+    }
+    if(const CompositeValidator* composite = dynamic_cast<const CompositeValidator*>(validator))
+    {
+        const QList<Validator*>* validators = composite->getValidatorList();
+        const QVector<CompositeValidator::LogicOperation>* operations = composite->getOperationList();
+        if((nullptr == validators)||(nullptr == operations))
+        {
+            return false;
+        }
+        writeValue<quint8>(out,COMPOSITE_VALIDATOR);
+        writeValue<quint32>(out,validators->size());
+        for(const Validator* child : *validators)
+        {
+            if(!writeValidator(out,child))
+            {
+                return false;
+            }
+        }
+        writeValue<quint32>(out,operations->size());
+        for(CompositeValidator::LogicOperation operation : *operations)
+        {
+            writeValue<quint8>(out,operation);
+        }
+        return true;
+    }
+    return false;
+}
+
+Validator* readValidator(Reader& reader,int depth = 0)
+{
+    // validators nest through composites and operations, a crafted blob must not exhaust the stack.
+    if(depth > MAX_VALIDATOR_DEPTH)
+    {
+        reader.invalidate();
+        return nullptr;
+    }
+    switch(reader.read<quint8>())
+    {
+    case BOOLEAN_CONDITION:
+    {
+        BooleanCondition* condition = new BooleanCondition();
+        quint8 logicOperator = reader.read<quint8>();
+        if(logicOperator > BooleanCondition::Different)
+        {
+            reader.invalidate();
+        }
+        condition->setOperator(static_cast<BooleanCondition::LogicOperator>(logicOperator));
+        condition->setValue(reader.read<qint64>());
+        return condition;
+    }
+    case RANGE:
+    {
+        Range* range = new Range();
+        quint8 flags = reader.read<quint8>();
+        qint64 start = reader.read<qint64>();
+        qint64 end = reader.read<qint64>();
+        if(flags & 1)
+        {
+            range->setStart(start);
+        }
+        if(flags & 2)
+        {
+            range->setEnd(end);
+        }
+        range->setEmptyRange(flags & 4);
+        return range;
+    }
+    case OPERATION_CONDITION:
+    {
+        OperationCondition* operation = new OperationCondition();
+        quint8 conditionOperator = reader.read<quint8>();
+        if(conditionOperator > OperationCondition::Modulo)
+        {
+            reader.invalidate();
+        }
+        operation->setOperator(static_cast<OperationCondition::ConditionOperator>(conditionOperator));
+        operation->setValue(reader.read<qint64>());
+        Validator* boolean = readValidator(reader,depth+1);
+        BooleanCondition* condition = dynamic_cast<BooleanCondition*>(boolean);
+        if(nullptr == condition)
+        {
+            delete boolean;
+            reader.invalidate();
+        }
+        operation->setBoolean(condition);
+        return operation;
+    }
+    case COMPOSITE_VALIDATOR:
+    {
+        QList<Validator*>* validators = new QList<Validator*>();
+        QVector<CompositeValidator::LogicOperation>* operations = new QVector<CompositeValidator::LogicOperation>();
+        CompositeValidator* composite = new CompositeValidator();
+        composite->setValidatorList(validators);
+        composite->setOperationList(operations);
+        quint32 count = reader.read<quint32>();
+        for(quint32 i = 0; (i < count)&&(reader.isValid()); ++i)
+        {
+            Validator* child = readValidator(reader,depth+1);
+            if(nullptr != child)
+            {
+                validators->append(child);
+            }
+        }
+        count = reader.read<quint32>();
+        for(quint32 i = 0; (i < count)&&(reader.isValid()); ++i)
+        {
+            quint8 operation = reader.read<quint8>();
+            if(operation > CompositeValidator::AND)
+            {
+                reader.invalidate();
+            }
+            operations->append(static_cast<CompositeValidator::LogicOperation>(operation));
+        }
+        // CompositeValidator reads one operation between two children.
+        if((validators->isEmpty())||(operations->size() != validators->size()-1))
+        {
+            reader.invalidate();
+        }
+        return composite;
+    }
+    default:
+        reader.invalidate();
+        return nullptr;
+    }
+}
+}
+
+DiceProgram::DiceProgram()
+    : m_hasStartingNode(false)
+{
+
+}
+DiceProgram::~DiceProgram()
+{
+    qDeleteAll(m_validators);
+}
+DiceProgram* DiceProgram::compile(ExecutionNode* start)
+{
+    DiceProgram* program = new DiceProgram();
+    ExecutionNode* first = start;
+    if(nullptr != dynamic_cast<StartingNode*>(start))
+    {
+        program->m_hasStartingNode = true;
+        first = start->getNextNode();
+    }
+    if((nullptr == first)||(!program->compileChain(first)))
+    {
+        delete program;
+        return nullptr;
+    }
+    return program;
+}
+bool DiceProgram::compileChain(ExecutionNode* node)
+{
+    OpCode previousCode = END_PARENTHESES;
+    bool first = true;
+    for(; nullptr != node; node = node->getNextNode())
+    {
+        // KEEP only needs to know if it follows a SORT, END_PARENTHESES stands for "anything else".
+        if(!compileNode(node,first ? END_PARENTHESES : previousCode))
+        {
+            return false;
+        }
+        previousCode = m_instructions.last().code;
+        first = false;
+    }
+    return true;
+}
+bool DiceProgram::compileNode(ExecutionNode* node,OpCode previousCode)
+{
+    if(NumberNode* number = dynamic_cast<NumberNode*>(node))
+    {
+        append(node,NUMBER,number->getNumber());
+    }
+    else if(DiceRollerNode* roller = dynamic_cast<DiceRollerNode*>(node))
+    {
+        append(node,ROLL,roller->getMinValue(),roller->getMaxValue(),static_cast<quint8>(roller->getOperator()));
+    }
+    else if(RerollDiceNode* reroll = dynamic_cast<RerollDiceNode*>(node))
+    {
+        if(nullptr == reroll->getValidator())
+        {
+            return false;
+        }
+        append(node,REROLL,0,0,reroll->isAddingMode() ? ADDING : NO_FLAG,reroll->getValidator());
+    }
+    else if(ExploseDiceNode* explode = dynamic_cast<ExploseDiceNode*>(node))
+    {
+        if(nullptr == explode->getValidator())
+        {
+            return false;
+        }
+        append(node,EXPLODE,0,0,NO_FLAG,explode->getValidator());
+    }
+    else if(SortResultNode* sort = dynamic_cast<SortResultNode*>(node))
+    {
+        append(node,SORT,0,0,sort->isAscending() ? ASCENDING : NO_FLAG);
+    }
+    else if(KeepDiceExecNode* keep = dynamic_cast<KeepDiceExecNode*>(node))
+    {
+        append(node,KEEP,static_cast<qint64>(keep->getDiceKeepNumber()),0,(previousCode == SORT) ? AFTER_SORT : NO_FLAG);
+    }
+    else if(FilterNode* filter = dynamic_cast<FilterNode*>(node))
+    {
+        if(nullptr == filter->getValidator())
+        {
+            return false;
+        }
+        append(node,FILTER,0,0,NO_FLAG,filter->getValidator());
+    }
+    else if(CountExecuteNode* count = dynamic_cast<CountExecuteNode*>(node))
+    {
+        if(nullptr == count->getValidator())
+        {
+            return false;
+        }
+        append(node,COUNT,0,0,NO_FLAG,count->getValidator());
+    }
+    else if(nullptr != dynamic_cast<JumpBackwardNode*>(node))
+    {
+        append(node,JUMP_BACKWARD);
+    }
+    else if(ScalarOperatorNode* op = dynamic_cast<ScalarOperatorNode*>(node))
+    {
+        if(nullptr == op->getInternalNode())
+        {
+            return false;
+        }
+        int begin = m_instructions.size();
+        append(node,BEGIN_OPERATOR);
+        if(!compileChain(op->getInternalNode()))
+        {
+            return false;
+        }
+        m_instructions[begin].a = m_instructions.size();
+        append(node,END_OPERATOR,static_cast<qint64>(op->getArithmeticOperator()));
+    }
+    else if(ParenthesesNode* parentheses = dynamic_cast<ParenthesesNode*>(node))
+    {
+        int begin = m_instructions.size();
+        append(node,BEGIN_PARENTHESES);
+        if((nullptr != parentheses->getInternalNode())&&(!compileChain(parentheses->getInternalNode())))
+        {
+            return false;
+        }
+        m_instructions[begin].a = m_instructions.size();
+        append(node,END_PARENTHESES);
+    }
+    else if(FusedRollNode* fused = dynamic_cast<FusedRollNode*>(node))
+    {
+        // the fused node gives the results of the general chain, so it is written as that chain.
+        append(node,NUMBER,fused->getDiceCount());
+        append(node,ROLL,fused->getMinValue(),fused->getMaxValue(),static_cast<quint8>(Die::PLUS));
+        switch(fused->getKernel())
+        {
+        case FusedRollNode::SUM:
+            break;
+        case FusedRollNode::SCALAR:
+        {
+            int begin = m_instructions.size();
+            append(node,BEGIN_OPERATOR);
+            append(node,NUMBER,fused->getOperand());
+            m_instructions[begin].a = m_instructions.size();
+            append(node,END_OPERATOR,static_cast<qint64>(fused->getScalarOperator()));
+        }
+            break;
+        case FusedRollNode::KEEP:
+            append(node,SORT,0,0,fused->isAscending() ? ASCENDING : NO_FLAG);
+            append(node,KEEP,fused->getKeepCount(),0,AFTER_SORT);
+            break;
+        case FusedRollNode::COUNT:
+            append(node,COUNT,0,0,NO_FLAG,fused->getValidator());
+            break;
+        }
+    }
+    else
+    {
+        return false;
+    }
+    return m_validators.size() <= MAX_VALIDATORS;
+}
+void DiceProgram::append(ExecutionNode* node,OpCode code,qint64 a,qint64 b,quint8 flag,const Validator* validator)
+{
+    Instruction instruction;
+    instruction.code = code;
+    instruction.flag = flag;
+    instruction.validator = -1;
+    instruction.position = node->getSourcePosition();
+    instruction.length = node->getSourceLength();
+    instruction.a = a;
+    instruction.b = b;
+    if(nullptr != validator)
+    {
+        instruction.validator = static_cast<qint16>(m_validators.size());
+        m_validators.append(validator->getCopy());
+    }
+    m_instructions.append(instruction);
+}
+const QVector<DiceProgram::Instruction>& DiceProgram::getInstructions() const
+{
+    return m_instructions;
+}
+const Validator* DiceProgram::getValidator(int index) const
+{
+    return m_validators.at(index);
+}
+bool DiceProgram::hasStartingNode() const
+{
+    return m_hasStartingNode;
+}
+QByteArray DiceProgram::serialize() const
+{
+    QByteArray out(PROGRAM_MAGIC);
+    writeValue<quint8>(out,m_hasStartingNode ? 1 : 0);
+    writeValue<quint32>(out,m_instructions.size());
+    for(const Instruction& instruction : m_instructions)
+    {
+        writeValue<quint8>(out,instruction.code);
+        writeValue<quint8>(out,instruction.flag);
+        writeValue<qint16>(out,instruction.validator);
+        writeValue<qint32>(out,instruction.position);
+        writeValue<qint32>(out,instruction.length);
+        writeValue<qint64>(out,instruction.a);
+        writeValue<qint64>(out,instruction.b);
+    }
+    writeValue<quint32>(out,m_validators.size());
+    for(const Validator* validator : m_validators)
+    {
+        if(!writeValidator(out,validator))
+        {
+            return QByteArray();
+        }
+    }
+    return out;
+}
+DiceProgram* DiceProgram::deserialize(const QByteArray& data)
+{
+    if(!data.startsWith(PROGRAM_MAGIC))
+    {
+        return nullptr;
+    }
+    Reader reader(data);
+    for(std::size_t i = 0; i < sizeof(PROGRAM_MAGIC)-1; ++i)
+    {
+        reader.read<quint8>();
+    }
+    DiceProgram* program = new DiceProgram();
+    program->m_hasStartingNode = (reader.read<quint8>() != 0);
+    quint32 count = reader.read<quint32>();
+    for(quint32 i = 0; (i < count)&&(reader.isValid()); ++i)
+    {
+        Instruction instruction;
+        instruction.code = static_cast<OpCode>(reader.read<quint8>());
+        instruction.flag = reader.read<quint8>();
+        instruction.validator = reader.read<qint16>();
+        instruction.position = reader.read<qint32>();
+        instruction.length = reader.read<qint32>();
+        instruction.a = reader.read<qint64>();
+        instruction.b = reader.read<qint64>();
+        program->m_instructions.append(instruction);
+    }
+    count = reader.read<quint32>();
+    for(quint32 i = 0; (i < count)&&(reader.isValid()); ++i)
+    {
+        Validator* validator = readValidator(reader);
+        if(nullptr != validator)
+        {
+            program->m_validators.append(validator);
+        }
+    }
+    // indexes are checked once here, the VM trusts them.
+    // BEGIN/END must nest: each END closes the last open BEGIN, of its kind, which points to it.
+    const int size = program->m_instructions.size();
+    QVector<int> openBegins;
+    for(int i = 0; (i < size)&&(reader.isValid()); ++i)
+    {
+        const Instruction& instruction = program->m_instructions.at(i);
+        bool validCode = (instruction.code <= END_PARENTHESES);
+        bool validValidator = (instruction.validator < program->m_validators.size());
+        bool needValidator = (instruction.code == REROLL)||(instruction.code == EXPLODE)||(instruction.code == FILTER)||(instruction.code == COUNT);
+        bool validJump = true;
+        if((instruction.code == BEGIN_OPERATOR)||(instruction.code == BEGIN_PARENTHESES))
+        {
+            openBegins.append(i);
+        }
+        else if((instruction.code == END_OPERATOR)||(instruction.code == END_PARENTHESES))
+        {
+            OpCode begin = (instruction.code == END_OPERATOR) ? BEGIN_OPERATOR : BEGIN_PARENTHESES;
+            validJump = !openBegins.isEmpty();
+            if(validJump)
+            {
+                const Instruction& opening = program->m_instructions.at(openBegins.takeLast());
+                validJump = (opening.code == begin)&&(opening.a == i);
+            }
+        }
+        if((!validCode)||(!validValidator)||(needValidator && instruction.validator < 0)||(!validJump))
+        {
+            reader.invalidate();
+        }
+    }
+    if((!reader.isValid())||(!reader.atEnd())||program->m_instructions.isEmpty()||(!openBegins.isEmpty()))
+    {
+        delete program;
+        return nullptr;
+    }
+    return program;
+}
@@ -0,0 +1,123 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef DICEPROGRAM_H
+#define DICEPROGRAM_H
+
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+
+#include "node/executionnode.h"
+#include "validator.h"
+#include "die.h"
+
+/**
+ * @brief The DiceProgram class is one instruction of a command compiled to a linear bytecode, run by DiceVm.
+ *
+ * Each node of the chain becomes one instruction. The internal chain of a ScalarOperatorNode or a ParenthesesNode is
+ * written inline between a BEGIN and an END instruction, BEGIN holds the index of its END. Validators are copied into
+ * a table and referenced by index. A program can be written to bytes and read back, see serialize().
+ *
+ * Only the nodes listed in OpCode are supported, compile() returns nullptr for other chains (IfNode, MergeNode,
+ * strings, lists...) which keep running on the tree.
+ */
+class DiceProgram
+{
+public:
+    /**
+     * @brief The OpCode enum, one code for each supported node.
+     */
+    enum OpCode : quint8 {NUMBER,ROLL,REROLL,EXPLODE,SORT,KEEP,FILTER,COUNT,JUMP_BACKWARD,
+                          BEGIN_OPERATOR,END_OPERATOR,BEGIN_PARENTHESES,END_PARENTHESES};
+    /**
+     * @brief The FLAG enum gives the meaning of the flag bits of an instruction.
+     */
+    enum FLAG : quint8 {NO_FLAG=0,ADDING=1,ASCENDING=2,AFTER_SORT=4};
+    /**
+     * @brief The Instruction struct, a and b depend on the code:
+     * NUMBER a: value; ROLL a: min b: max, operator in flag; KEEP a: number of dice;
+     * BEGIN_* a: index of the matching END; END_OPERATOR a: arithmetic operator.
+     */
+    struct Instruction
+    {
+        OpCode code;
+        quint8 flag;
+        qint16 validator;
+        qint32 position;
+        qint32 length;
+        qint64 a;
+        qint64 b;
+    };
+
+    /**
+     * @brief DiceProgram
+     */
+    DiceProgram();
+    virtual ~DiceProgram();
+    /**
+     * @brief compile lowers one instruction of the execution tree.
+     * @param start first node of the instruction, a StartingNode or not.
+     * @return the program or nullptr when a node is not supported.
+     */
+    static DiceProgram* compile(ExecutionNode* start);
+
+    /**
+     * @brief getInstructions
+     * @return
+     */
+    const QVector<DiceProgram::Instruction>& getInstructions() const;
+    /**
+     * @brief getValidator
+     * @param index
+     * @return validator owned by the program.
+     */
+    const Validator* getValidator(int index) const;
+    /**
+     * @brief hasStartingNode
+     * @return true if the instruction starts with a StartingNode: nodes then find no result before the first one.
+     */
+    bool hasStartingNode() const;
+
+    /**
+     * @brief serialize writes the program to bytes.
+     * @return
+     */
+    QByteArray serialize() const;
+    /**
+     * @brief deserialize reads a program written by serialize.
+     * @param data
+     * @return the program or nullptr if data is not a valid program.
+     */
+    static DiceProgram* deserialize(const QByteArray& data);
+
+private:
+    bool compileChain(ExecutionNode* node);
+    bool compileNode(ExecutionNode* node,OpCode previousCode);
+    void append(ExecutionNode* node,OpCode code,qint64 a = 0,qint64 b = 0,quint8 flag = NO_FLAG,const Validator* validator = nullptr);
+
+private:
+    QVector<DiceProgram::Instruction> m_instructions;
+    QList<Validator*> m_validators;
+    bool m_hasStartingNode;
+};
+
+#endif // DICEPROGRAM_H
@@ -0,0 +1,72 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef DICEVISITOR_H
+#define DICEVISITOR_H
+
+#include <QList>
+#include <QString>
+
+/**
+ * @brief The DiceVisitor class receives the dice to display straight from the results, see DiceParser::visitDice.
+ *
+ * Dice are grouped by instruction then by faces, in the order of getLastDiceResult. Nothing is copied: the values
+ * and the color are references to the die storage, they are valid during the call only.
+ */
+class DiceVisitor
+{
+public:
+    /**
+     * @brief ~DiceVisitor
+     */
+    virtual ~DiceVisitor();
+    /**
+     * @brief beginInstruction is called for each instruction of the command (separated by ;).
+     * @param index
+     */
+    virtual void beginInstruction(int index);
+    /**
+     * @brief endInstruction
+     * @param index
+     */
+    virtual void endInstruction(int index);
+    /**
+     * @brief beginFace is called before the dice of a kind.
+     * @param face number of faces of the dice.
+     * @param faceCount number of dice kinds in this instruction.
+     */
+    virtual void beginFace(quint64 face,int faceCount);
+    /**
+     * @brief endFace
+     * @param face
+     */
+    virtual void endFace(quint64 face);
+    /**
+     * @brief visitDie
+     * @param value final value of the die.
+     * @param rolls all rolled values, they are details of the value when there are several of them.
+     * @param highlighted
+     * @param color empty when the die has no color.
+     */
+    virtual void visitDie(qint64 value,const QList<qint64>& rolls,bool highlighted,const QString& color) = 0;
+};
+
+#endif // DICEVISITOR_H
@@ -0,0 +1,523 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include "dicevm.h"
+
+#include <QObject>
+
+#include "diagnostics.h"
+#include "evaluationbudget.h"
+#include "result/scalarresult.h"
+#include "result/dicehistogram.h"
+#include "node/sortresult.h"
+
+DiceVm::DiceVm()
+    : m_program(nullptr)
+{
+
+}
+DiceVm::~DiceVm()
+{
+    clear();
+}
+void DiceVm::clear()
+{
+    qDeleteAll(m_results);
+    m_results.clear();
+    m_slots.clear();
+    m_path.clear();
+    m_frames.clear();
+    m_fixups.clear();
+    m_program = nullptr;
+}
+Result* DiceVm::getLeafResult() const
+{
+    if(m_slots.isEmpty())
+    {
+        return nullptr;
+    }
+    return m_slots.last();
+}
+void DiceVm::createResults(const DiceProgram* program)
+{
+    // one result per node, as the tree: a result stays empty when its node does not run.
+    const QVector<DiceProgram::Instruction>& instructions = program->getInstructions();
+    m_slots.fill(nullptr,instructions.size());
+    for(int pc = 0; pc < instructions.size(); ++pc)
+    {
+        const DiceProgram::Instruction& instruction = instructions.at(pc);
+        Result* result = nullptr;
+        switch(instruction.code)
+        {
+        case DiceProgram::NUMBER:
+        {
+            ScalarResult* scalar = new ScalarResult();
+            scalar->setValue(instruction.a);
+            result = scalar;
+        }
+            break;
+        case DiceProgram::COUNT:
+        case DiceProgram::BEGIN_OPERATOR:
+        {
+            ScalarResult* scalar = new ScalarResult();
+            scalar->setValue(0);
+            result = scalar;
+        }
+            break;
+        case DiceProgram::ROLL:
+        {
+            DiceResult* dice = new DiceResult();
+            dice->setOperator(static_cast<Die::ArithmeticOperator>(instruction.flag));
+            result = dice;
+        }
+            break;
+        case DiceProgram::REROLL:
+        case DiceProgram::EXPLODE:
+        case DiceProgram::SORT:
+        case DiceProgram::KEEP:
+        case DiceProgram::FILTER:
+        case DiceProgram::JUMP_BACKWARD:
+            result = new DiceResult();
+            break;
+        case DiceProgram::END_OPERATOR:
+        case DiceProgram::BEGIN_PARENTHESES:
+        case DiceProgram::END_PARENTHESES:
+            break;
+        }
+        if(nullptr != result)
+        {
+            m_results.append(result);
+        }
+        m_slots[pc] = result;
+        if(instruction.code == DiceProgram::BEGIN_OPERATOR)
+        {
+            m_slots[static_cast<int>(instruction.a)] = result;
+        }
+    }
+}
+void DiceVm::run(const DiceProgram* program)
+{
+    clear();
+    if(nullptr == program)
+    {
+        return;
+    }
+    m_program = program;
+    createResults(program);
+    if(program->hasStartingNode())
+    {
+        m_path.append({nullptr,-1,false});
+    }
+    const QVector<DiceProgram::Instruction>& instructions = program->getInstructions();
+    int pc = 0;
+    while(pc < instructions.size())
+    {
+        if(runInstruction(program,pc))
+        {
+            ++pc;
+        }
+        else if(m_frames.isEmpty())
+        {
+            break;
+        }
+        else
+        {
+            // the node stops its chain: back to the operator or the parentheses which runs it.
+            pc = static_cast<int>(instructions.at(m_frames.last().begin).a);
+        }
+    }
+    runFixups(0);
+}
+bool DiceVm::runInstruction(const DiceProgram* program,int pc)
+{
+    const DiceProgram::Instruction& instruction = program->getInstructions().at(pc);
+    const int top = m_path.size()-1;
+    const bool hasPrevious = (top >= 0);
+    Result* previous = hasPrevious ? m_path.at(top).result : nullptr;
+    Result* current = m_slots.at(pc);
+
+    switch(instruction.code)
+    {
+    case DiceProgram::NUMBER:
+        if(hasPrevious)
+        {
+            current->setPrevious(previous);
+        }
+        break;
+    case DiceProgram::ROLL:
+    {
+        if(nullptr == previous)
+        {
+            return false;
+        }
+        DiceResult* diceResult = static_cast<DiceResult*>(current);
+        const qreal count = previous->scalar();
+        current->setPrevious(previous);
+        if(count < 0)
+        {
+            addError(pc,ExecutionNode::NO_DICE_TO_ROLL,QObject::tr("Can't roll a negative number of dice: %1").arg(count));
+            return false;
+        }
+        const quint64 diceCount = static_cast<quint64>(count);
+        if(diceCount == 0)
+        {
+            addError(pc,ExecutionNode::NO_DICE_TO_ROLL,QObject::tr("No dice to roll"));
+        }
+        EvaluationBudget* budget = EvaluationBudget::current();
+        if((nullptr!=budget)&&(!budget->allocateDice(static_cast<qint64>(diceCount))))
+        {
+            addError(pc,ExecutionNode::BUDGET_EXCEEDED,budget->getErrorMessage());
+            return false;
+        }
+        for(quint64 i = 0; i < diceCount; ++i)
+        {
+            if(isBudgetExhausted(pc))
+            {
+                return false;
+            }
+            Die* die = new Die();
+            die->setOp(static_cast<Die::ArithmeticOperator>(instruction.flag));
+            die->setBase(instruction.a);
+            die->setMaxValue(instruction.b);
+            die->roll();
+            diceResult->insertResult(die);
+        }
+    }
+        break;
+    case DiceProgram::REROLL:
+    case DiceProgram::EXPLODE:
+    {
+        DiceResult* previousDiceResult = dynamic_cast<DiceResult*>(previous);
+        if(nullptr == previousDiceResult)
+        {
+            return false;
+        }
+        DiceResult* diceResult = static_cast<DiceResult*>(current);
+        const Validator* validator = program->getValidator(instruction.validator);
+        current->setPrevious(previousDiceResult);
+        for(Die* die : previousDiceResult->getDiceList())
+        {
+            Die* tmpdie = new Die();
+            *tmpdie = *die;
+            diceResult->insertResult(tmpdie);
+            die->displayed();
+        }
+        const bool explode = (instruction.code == DiceProgram::EXPLODE);
+        for(Die* die : diceResult->getResultList())
+        {
+            if(explode)
+            {
+                while(validator->hasValid(die,false))
+                {
+                    if(isBudgetExhausted(pc))
+                    {
+                        return false;
+                    }
+                    die->roll(true);
+                }
+            }
+            else
+            {
+                if(isBudgetExhausted(pc))
+                {
+                    return false;
+                }
+                if(validator->hasValid(die,false))
+                {
+                    die->roll(instruction.flag & DiceProgram::ADDING);
+                }
+            }
+        }
+        diceResult->invalidateHistogram();
+    }
+        break;
+    case DiceProgram::SORT:
+    {
+        if(!hasPrevious)
+        {
+            return false;
+        }
+        DiceResult* previousDiceResult = dynamic_cast<DiceResult*>(previous);
+        DiceResult* diceResult = static_cast<DiceResult*>(current);
+        current->setPrevious(previousDiceResult);
+        if(nullptr == previousDiceResult)
+        {
+            return false;
+        }
+        diceResult->setBorrowedResultList(SortResultNode::sortDice(previousDiceResult->getDiceList(),instruction.flag & DiceProgram::ASCENDING));
+        DiceHistogram* histogram = previousDiceResult->getHistogram();
+        if(nullptr!=histogram)
+        {
+            diceResult->setHistogram(*histogram);
+        }
+    }
+        break;
+    case DiceProgram::KEEP:
+    {
+        DiceResult* previousDiceResult = dynamic_cast<DiceResult*>(previous);
+        if(nullptr == previousDiceResult)
+        {
+            return false;
+        }
+        DiceResult* diceResult = static_cast<DiceResult*>(current);
+        current->setPrevious(previousDiceResult);
+        const quint64 numberOfDice = static_cast<quint64>(instruction.a);
+        const QList<Die*>& diceList = previousDiceResult->getDiceList();
+        QList<Die*> diceList2 = diceList.mid(0,static_cast<int>(numberOfDice));
+        if(numberOfDice > static_cast<quint64>(diceList.size()))
+        {
+            addError(pc,ExecutionNode::TOO_MANY_DICE,QObject::tr(" You ask to keep %1 dice but the result only has %2").arg(numberOfDice).arg(diceList.size()));
+        }
+        for(int i = diceList2.size(); i < diceList.size(); ++i)
+        {
+            diceList[i]->setHighlighted(false);
+        }
+        diceResult->setBorrowedResultList(diceList2);
+        DiceHistogram* histogram = previousDiceResult->getHistogram();
+        if((nullptr!=histogram)&&(instruction.flag & DiceProgram::AFTER_SORT)&&(!diceList.isEmpty()))
+        {
+            if(diceList.first()->getValue() <= diceList.last()->getValue())
+            {
+                diceResult->setHistogram(histogram->getLowest(numberOfDice));
+            }
+            else
+            {
+                diceResult->setHistogram(histogram->getHighest(numberOfDice));
+            }
+        }
+    }
+        break;
+    case DiceProgram::FILTER:
+    {
+        DiceResult* previousDiceResult = dynamic_cast<DiceResult*>(previous);
+        if(nullptr == previousDiceResult)
+        {
+            return false;
+        }
+        DiceResult* diceResult = static_cast<DiceResult*>(current);
+        const Validator* validator = program->getValidator(instruction.validator);
+        current->setPrevious(previousDiceResult);
+        QList<Die*> diceList = previousDiceResult->getDiceList();
+        QList<Die*> diceList2;
+        DiceHistogram* histogram = previousDiceResult->getHistogram();
+        if(nullptr!=histogram)
+        {
+            DiceHistogram evaluated(*histogram);
+            evaluated.evaluate(validator,false,false);
+            evaluated.applyHighlight(diceList);
+            for(Die* tmp : diceList)
+            {
+                if(evaluated.getValidity(tmp->getValue()))
+                {
+                    diceList2.append(tmp);
+                }
+                else
+                {
+                    tmp->setHighlighted(false);
+                }
+            }
+            diceResult->setBorrowedResultList(diceList2);
+            diceResult->setHistogram(evaluated.getValidPart());
+        }
+        else
+        {
+            for(Die* tmp : diceList)
+            {
+                if(validator->hasValid(tmp,false))
+                {
+                    diceList2.append(tmp);
+                }
+                else
+                {
+                    tmp->setHighlighted(false);
+                }
+            }
+            diceResult->setBorrowedResultList(diceList2);
+        }
+    }
+        break;
+    case DiceProgram::COUNT:
+    {
+        DiceResult* previousDiceResult = dynamic_cast<DiceResult*>(previous);
+        if(nullptr == previousDiceResult)
+        {
+            return false;
+        }
+        const Validator* validator = program->getValidator(instruction.validator);
+        current->setPrevious(previousDiceResult);
+        QList<Die*> diceList = previousDiceResult->getDiceList();
+        qint64 sum = 0;
+        DiceHistogram* histogram = previousDiceResult->getHistogram();
+        if(nullptr!=histogram)
+        {
+            DiceHistogram evaluated(*histogram);
+            sum = evaluated.evaluate(validator,true,true);
+            evaluated.applyHighlight(diceList);
+        }
+        else
+        {
+            for(Die* die : diceList)
+            {
+                sum += validator->hasValid(die,true,true);
+            }
+        }
+        static_cast<ScalarResult*>(current)->setValue(sum);
+    }
+        break;
+    case DiceProgram::JUMP_BACKWARD:
+    {
+        int parent = top;
+        bool found = false;
+        Result* result = nullptr;
+        while((parent >= 0)&&(!found))
+        {
+            const PathEntry& entry = m_path.at(parent);
+            result = entry.result;
+            if((nullptr!=result)&&((result->hasResultOfType(Result::DICE_LIST))||(entry.jump)))
+            {
+                found = true;
+            }
+            else
+            {
+                parent = entry.previous;
+            }
+        }
+        if(nullptr==result)
+        {
+            addError(pc,ExecutionNode::DIE_RESULT_EXPECTED,QObject::tr(" The @ operator expects dice result. Please check the documentation to fix your command."));
+            return false;
+        }
+        DiceResult* diceResult = static_cast<DiceResult*>(current);
+        DiceResult* foundDiceResult = dynamic_cast<DiceResult*>(result);
+        if(nullptr!=foundDiceResult)
+        {
+            for(Die* die : foundDiceResult->getDiceList())
+            {
+                Die* tmpdie = new Die();
+                *tmpdie = *die;
+                diceResult->insertResult(tmpdie);
+                die->displayed();
+            }
+            m_fixups.append({foundDiceResult,diceResult});
+        }
+        current->setPrevious(previous);
+    }
+        break;
+    case DiceProgram::BEGIN_OPERATOR:
+    case DiceProgram::BEGIN_PARENTHESES:
+    {
+        const bool parentheses = (instruction.code == DiceProgram::BEGIN_PARENTHESES);
+        m_frames.append({pc,m_path.size(),m_fixups.size()});
+        // parentheses have no previous node and no result until their internal chain has run.
+        m_path.append({current,parentheses ? -1 : top,false});
+    }
+        return true;
+    case DiceProgram::END_OPERATOR:
+    case DiceProgram::END_PARENTHESES:
+    {
+        Frame frame = m_frames.takeLast();
+        runFixups(frame.fixups);
+        Result* internalResult = (pc - 1 > frame.begin) ? m_slots.at(pc-1) : nullptr;
+        m_path.resize(frame.path+1);
+        PathEntry& entry = m_path.last();
+        if(instruction.code == DiceProgram::END_PARENTHESES)
+        {
+            m_slots[frame.begin] = internalResult;
+            m_slots[pc] = internalResult;
+            entry.result = internalResult;
+            return true;
+        }
+        Result* outerResult = (entry.previous >= 0) ? m_path.at(entry.previous).result : nullptr;
+        if(nullptr == outerResult)
+        {
+            return false;
+        }
+        qint64 a = outerResult->scalar();
+        qint64 b = (nullptr!=internalResult) ? internalResult->scalar() : 0;
+        ScalarResult* scalar = static_cast<ScalarResult*>(entry.result);
+        switch(static_cast<Die::ArithmeticOperator>(instruction.a))
+        {
+        case Die::PLUS:
+            scalar->setValue(a+b);
+            break;
+        case Die::MINUS:
+            scalar->setValue(a-b);
+            break;
+        case Die::MULTIPLICATION:
+            scalar->setValue(a*b);
+            break;
+        case Die::DIVIDE:
+            if(b==0)
+            {
+                addError(pc,ExecutionNode::DIVIDE_BY_ZERO,QObject::tr("Division by zero"));
+                scalar->setValue(0);
+            }
+            else
+            {
+                scalar->setValue((qreal)a/b);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+        return true;
+    }
+    m_path.append({current,top,instruction.code == DiceProgram::JUMP_BACKWARD});
+    return true;
+}
+void DiceVm::runFixups(int from)
+{
+    // the latest @ is the deepest node of the tree, its chain returns first.
+    for(int i = m_fixups.size()-1; i >= from; --i)
+    {
+        const Fixup& fixup = m_fixups.at(i);
+        const QList<Die*>& source = fixup.source->getDiceList();
+        const QList<Die*>& copy = fixup.copy->getDiceList();
+        for(int j = 0; (j < source.size())&&(j < copy.size()); ++j)
+        {
+            if(source.at(j)->isHighlighted())
+            {
+                copy.at(j)->setHighlighted(true);
+            }
+        }
+    }
+    m_fixups.resize(from);
+}
+bool DiceVm::isBudgetExhausted(int pc)
+{
+    EvaluationBudget* budget = EvaluationBudget::current();
+    if((nullptr!=budget)&&(budget->isExhausted()))
+    {
+        addError(pc,ExecutionNode::BUDGET_EXCEEDED,budget->getErrorMessage());
+        return true;
+    }
+    return false;
+}
+void DiceVm::addError(int pc,ExecutionNode::DICE_ERROR_CODE code,const QString& message)
+{
+    Diagnostics* diagnostics = Diagnostics::current();
+    if(nullptr!=diagnostics)
+    {
+        const DiceProgram::Instruction& instruction = m_program->getInstructions().at(pc);
+        diagnostics->addError(code,message,QStringLiteral("\"instruction %1\"").arg(pc),instruction.position,instruction.length);
+    }
+}
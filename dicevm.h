@@ -0,0 +1,105 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef DICEVM_H
+#define DICEVM_H
+
+#include <QVector>
+#include <QList>
+
+#include "diceprogram.h"
+#include "result/result.h"
+#include "result/diceresult.h"
+
+/**
+ * @brief The DiceVm class runs a DiceProgram with a dispatch loop, it gives the same results as the tree.
+ *
+ * The VM keeps the path of results the tree would walk through getPreviousNode(). When a node of the tree would
+ * stop its chain, the VM jumps to the END of the enclosing operator or parentheses, or to the end of the program.
+ * Results are owned by the VM until the next run or clear().
+ */
+class DiceVm
+{
+public:
+    /**
+     * @brief DiceVm
+     */
+    DiceVm();
+    virtual ~DiceVm();
+    /**
+     * @brief run runs the program, errors go to the current Diagnostics and the current EvaluationBudget is charged.
+     * @param program
+     */
+    void run(const DiceProgram* program);
+    /**
+     * @brief getLeafResult
+     * @return result of the last instruction, as the leaf node of the tree.
+     */
+    Result* getLeafResult() const;
+    /**
+     * @brief clear releases the results of the last run.
+     */
+    void clear();
+
+private:
+    /**
+     * @brief The PathEntry struct, one result the tree would reach by getPreviousNode().
+     */
+    struct PathEntry
+    {
+        Result* result;
+        int previous;
+        bool jump;
+    };
+    /**
+     * @brief The Frame struct, one operator or parentheses being run.
+     */
+    struct Frame
+    {
+        int begin;
+        int path;
+        int fixups;
+    };
+    /**
+     * @brief The Fixup struct, highlight copied back by @ once the rest of its chain has run.
+     */
+    struct Fixup
+    {
+        DiceResult* source;
+        DiceResult* copy;
+    };
+
+    void createResults(const DiceProgram* program);
+    bool runInstruction(const DiceProgram* program,int pc);
+    void runFixups(int from);
+    bool isBudgetExhausted(int pc);
+    void addError(int pc,ExecutionNode::DICE_ERROR_CODE code,const QString& message);
+
+private:
+    const DiceProgram* m_program;
+    QVector<Result*> m_slots;
+    QList<Result*> m_results;
+    QVector<PathEntry> m_path;
+    QVector<Frame> m_frames;
+    QVector<Fixup> m_fixups;
+};
+
+#endif // DICEVM_H
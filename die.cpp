@@ -21,11 +21,31 @@
 ***************************************************************************/
 
 #include "die.h"
+#include "evaluationbudget.h"
 
 #include <QDateTime>
 #include <QDebug>
 #include <chrono>
 
+namespace
+{
+thread_local std::mt19937* s_generator = nullptr;
+}
+
+Die::RandomScope::RandomScope(std::mt19937* generator)
+    : m_previous(s_generator)
+{
+    s_generator = generator;
+}
+Die::RandomScope::~RandomScope()
+{
+    s_generator = m_previous;
+}
+std::mt19937* Die::currentGenerator()
+{
+    return s_generator;
+}
+
 Die::Die()
     : m_hasValue(false),m_displayStatus(false),m_highlighted(true),m_base(1),m_color(""),m_op(Die::PLUS)//,m_mt(m_randomDevice)
 {
@@ -118,7 +138,7 @@ qint64 Die::getValue() const
         return value;
     }
 }
-QList<qint64> Die::getListValue() const
+const QList<qint64>& Die::getListValue() const
 {
     return m_rollResult;
 }
@@ -138,8 +158,14 @@ void Die::roll(bool adding)
     {
         //quint64 value=(qrand()%m_faces)+m_base;
 
+        EvaluationBudget* budget = EvaluationBudget::current();
+        if(nullptr!=budget)
+        {
+            budget->addRolls(1);
+        }
+
         std::uniform_int_distribution<qint64> dist(m_base,m_maxValue);
-        qint64 value = dist(m_rng);
+        qint64 value = (nullptr!=s_generator) ? dist(*s_generator) : dist(m_rng);
         if((adding)||(m_rollResult.isEmpty()))
         {
             insertRollValue(value);
@@ -190,7 +216,7 @@ void Die::setBase(qint64 base)
 {
         m_base = base;
 }
-QString Die::getColor() const
+const QString& Die::getColor() const
 {
     return m_color;
 }
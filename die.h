@@ -35,6 +35,23 @@ public:
      * @brief The ArithmeticOperator enum
      */
     enum ArithmeticOperator {PLUS,MINUS,DIVIDE,MULTIPLICATION,POWER};
+    /**
+     * @brief The RandomScope class makes every die of the calling thread roll with one generator until it is destroyed.
+     * Two runs under the same seed give the same values, this is used to compare both execution backends.
+     */
+    class RandomScope
+    {
+    public:
+        explicit RandomScope(std::mt19937* generator);
+        ~RandomScope();
+    private:
+        std::mt19937* m_previous;
+    };
+    /**
+     * @brief currentGenerator
+     * @return the generator set by a RandomScope on the calling thread, nullptr when each die uses its own one.
+     */
+    static std::mt19937* currentGenerator();
     /**
      * @brief Die
      */
@@ -77,7 +94,7 @@ public:
      * @brief getListValue
      * @return
      */
-    QList<qint64> getListValue() const;
+    const QList<qint64>& getListValue() const;
     /**
      * @brief hasChildrenValue
      * @return
@@ -129,7 +146,7 @@ public:
      */
     void setBase(qint64);
 
-    QString getColor() const;
+    const QString& getColor() const;
     void setColor(const QString &color);
 
     qint64 getMaxValue() const;
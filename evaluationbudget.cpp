@@ -0,0 +1,253 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include "evaluationbudget.h"
+
+#include <QAtomicInteger>
+#include <QObject>
+
+#include "die.h"
+
+#define TIME_CHECK_PERIOD 128
+
+namespace
+{
+thread_local EvaluationBudget* s_current = nullptr;
+}
+
+/**
+ * @brief The EvaluationBudget::Shared struct, the totals of the parts given by split(), indexed by LIMIT.
+ */
+struct EvaluationBudget::Shared
+{
+    QAtomicInteger<qint64> counts[EvaluationBudget::MEMORY+1];
+    QAtomicInt exhausted;
+};
+
+EvaluationBudget::Scope::Scope(EvaluationBudget* budget)
+    : m_previous(s_current)
+{
+    s_current = budget;
+}
+EvaluationBudget::Scope::~Scope()
+{
+    s_current = m_previous;
+}
+
+EvaluationBudget::EvaluationBudget()
+    : m_maxDice(100000),m_maxRolls(1000000),m_maxNodes(10000),m_maxTime(2000),m_maxBytes(64*1024*1024)
+{
+    reset();
+}
+
+EvaluationBudget* EvaluationBudget::current()
+{
+    return s_current;
+}
+
+void EvaluationBudget::reset()
+{
+    m_diceCount = 0;
+    m_rollCount = 0;
+    m_nodeCount = 0;
+    m_byteCount = 0;
+    m_exhausted = NONE;
+    m_start = std::chrono::steady_clock::now();
+    m_timeChecks = 0;
+}
+void EvaluationBudget::charge(EvaluationBudget::LIMIT limit, qint64& counter, qint64 count, qint64 max)
+{
+    // nodes check their counts before charging them, a negative count would give budget back.
+    Q_ASSERT(count >= 0);
+    if(count <= 0)
+    {
+        return;
+    }
+    counter += count;
+    if(m_shared.isNull())
+    {
+        check(limit,counter,max);
+        return;
+    }
+    check(limit,m_shared->counts[limit].fetchAndAddRelaxed(count)+count,max);
+}
+void EvaluationBudget::check(EvaluationBudget::LIMIT limit, qint64 value, qint64 max)
+{
+    if((NONE == m_exhausted)&&(max > 0)&&(value > max))
+    {
+        m_exhausted = limit;
+        if(!m_shared.isNull())
+        {
+            // the other parts stop at their next isExhausted().
+            m_shared->exhausted.testAndSetRelease(NONE,limit);
+        }
+    }
+}
+bool EvaluationBudget::allocateDice(qint64 count)
+{
+    charge(DICE,m_diceCount,count,m_maxDice);
+    const qint64 used = m_shared.isNull() ? m_byteCount : m_shared->counts[MEMORY].loadAcquire();
+    check(MEMORY,used+count*static_cast<qint64>(sizeof(Die)),m_maxBytes);
+    return !isExhausted();
+}
+void EvaluationBudget::addRolls(qint64 count)
+{
+    charge(ROLLS,m_rollCount,count,m_maxRolls);
+}
+void EvaluationBudget::addNodes(qint64 count)
+{
+    charge(NODES,m_nodeCount,count,m_maxNodes);
+}
+void EvaluationBudget::addBytes(qint64 bytes)
+{
+    charge(MEMORY,m_byteCount,bytes,m_maxBytes);
+}
+QVector<EvaluationBudget> EvaluationBudget::split(int count) const
+{
+    // the totals start from what the command has already used.
+    QSharedPointer<Shared> shared(new Shared());
+    shared->counts[DICE].storeRelease(m_diceCount);
+    shared->counts[ROLLS].storeRelease(m_rollCount);
+    shared->counts[NODES].storeRelease(m_nodeCount);
+    shared->counts[MEMORY].storeRelease(m_byteCount);
+    shared->exhausted.storeRelease(m_exhausted);
+
+    EvaluationBudget part(*this);
+    part.m_diceCount = 0;
+    part.m_rollCount = 0;
+    part.m_nodeCount = 0;
+    part.m_byteCount = 0;
+    part.m_timeChecks = 0;
+    part.m_shared = shared;
+    return QVector<EvaluationBudget>(count,part);
+}
+void EvaluationBudget::merge(const EvaluationBudget& part)
+{
+    if((NONE == m_exhausted)&&(!part.m_shared.isNull()))
+    {
+        m_exhausted = static_cast<EvaluationBudget::LIMIT>(part.m_shared->exhausted.loadAcquire());
+    }
+    if(NONE == m_exhausted)
+    {
+        m_exhausted = part.m_exhausted;
+    }
+    m_diceCount += part.m_diceCount;
+    check(DICE,m_diceCount,m_maxDice);
+    m_rollCount += part.m_rollCount;
+    check(ROLLS,m_rollCount,m_maxRolls);
+    m_nodeCount += part.m_nodeCount;
+    check(NODES,m_nodeCount,m_maxNodes);
+    m_byteCount += part.m_byteCount;
+    check(MEMORY,m_byteCount,m_maxBytes);
+}
+bool EvaluationBudget::isExhausted()
+{
+    if((NONE == m_exhausted)&&(!m_shared.isNull()))
+    {
+        m_exhausted = static_cast<EvaluationBudget::LIMIT>(m_shared->exhausted.loadAcquire());
+    }
+    // reading the clock costs as much as rolling a die.
+    if((NONE == m_exhausted)&&(m_maxTime > 0)&&(0 == (m_timeChecks++ % TIME_CHECK_PERIOD)))
+    {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-m_start).count();
+        check(TIME,elapsed,m_maxTime);
+    }
+    return NONE != m_exhausted;
+}
+EvaluationBudget::LIMIT EvaluationBudget::getExhaustedLimit() const
+{
+    return m_exhausted;
+}
+QString EvaluationBudget::getErrorMessage() const
+{
+    switch(m_exhausted)
+    {
+    case DICE:
+        return QObject::tr("Too many dice: the command may not roll more than %1 dice").arg(m_maxDice);
+    case ROLLS:
+        return QObject::tr("Too many rolls: the command may not roll dice more than %1 times").arg(m_maxRolls);
+    case NODES:
+        return QObject::tr("The command is too complex: it may not be made of more than %1 operations").arg(m_maxNodes);
+    case TIME:
+        return QObject::tr("The command takes too long: it has been stopped after %1 ms").arg(m_maxTime);
+    case MEMORY:
+        return QObject::tr("The command uses too much memory: it may not use more than %1 bytes").arg(m_maxBytes);
+    default:
+        return QString();
+    }
+}
+
+qint64 EvaluationBudget::getMaxDice() const
+{
+    return m_maxDice;
+}
+void EvaluationBudget::setMaxDice(qint64 maxDice)
+{
+    m_maxDice = maxDice;
+}
+qint64 EvaluationBudget::getMaxRolls() const
+{
+    return m_maxRolls;
+}
+void EvaluationBudget::setMaxRolls(qint64 maxRolls)
+{
+    m_maxRolls = maxRolls;
+}
+qint64 EvaluationBudget::getMaxNodes() const
+{
+    return m_maxNodes;
+}
+void EvaluationBudget::setMaxNodes(qint64 maxNodes)
+{
+    m_maxNodes = maxNodes;
+}
+qint64 EvaluationBudget::getMaxTime() const
+{
+    return m_maxTime;
+}
+void EvaluationBudget::setMaxTime(qint64 milliseconds)
+{
+    m_maxTime = milliseconds;
+}
+qint64 EvaluationBudget::getMaxBytes() const
+{
+    return m_maxBytes;
+}
+void EvaluationBudget::setMaxBytes(qint64 maxBytes)
+{
+    m_maxBytes = maxBytes;
+}
+qint64 EvaluationBudget::getDiceCount() const
+{
+    return m_diceCount;
+}
+qint64 EvaluationBudget::getRollCount() const
+{
+    return m_rollCount;
+}
+qint64 EvaluationBudget::getNodeCount() const
+{
+    return m_nodeCount;
+}
+qint64 EvaluationBudget::getByteCount() const
+{
+    return m_byteCount;
+}
@@ -0,0 +1,165 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef EVALUATIONBUDGET_H
+#define EVALUATIONBUDGET_H
+
+#include <QString>
+#include <QSharedPointer>
+#include <QVector>
+#include <chrono>
+
+/**
+ * @brief The EvaluationBudget class bounds the resources a single command may consume.
+ *
+ * DiceParser resets its budget at each parseLine() and Start() and activates it while parsing and running the tree.
+ * Nodes reach the active budget through EvaluationBudget::current(), charge what they are about to consume
+ * and stop their work as soon as isExhausted() returns true. A limit set to 0 means unlimited.
+ */
+class EvaluationBudget
+{
+public:
+    /**
+     * @brief The LIMIT enum lists every bounded resource.
+     */
+    enum LIMIT {NONE,DICE,ROLLS,NODES,TIME,MEMORY};
+    /**
+     * @brief The Scope class makes a budget the current one for the calling thread until it is destroyed.
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(EvaluationBudget* budget);
+        ~Scope();
+    private:
+        EvaluationBudget* m_previous;
+    };
+
+    /**
+     * @brief EvaluationBudget default limits are designed for a shared bot: large enough for any real command.
+     */
+    EvaluationBudget();
+
+    /**
+     * @brief current
+     * @return the budget active on the calling thread, nullptr when none.
+     */
+    static EvaluationBudget* current();
+
+    /**
+     * @brief reset clears the counters and restarts the clock.
+     */
+    void reset();
+
+    /**
+     * @brief allocateDice charges dice before they are created. Their memory is only checked here, it is
+     * charged with addBytes() by the result which stores them.
+     * @param count number of dice, callers reject negative counts before.
+     * @return false if the budget is exhausted.
+     */
+    bool allocateDice(qint64 count);
+    /**
+     * @brief addRolls charges rolls (first rolls, rerolls and explosions).
+     */
+    void addRolls(qint64 count);
+    /**
+     * @brief addNodes charges execution nodes created while parsing or running.
+     */
+    void addNodes(qint64 count);
+    /**
+     * @brief addBytes charges memory used by results and intermediate values.
+     */
+    void addBytes(qint64 bytes);
+
+    /**
+     * @brief split gives the budgets of parts of the command run on other threads.
+     * The parts charge their own counters and shared totals, so the limits are checked on the whole command
+     * while it runs: once one part crosses a limit, every part sees the budget exhausted.
+     * @param count number of parts.
+     * @return budgets with the same limits and clock, and counters at zero.
+     */
+    QVector<EvaluationBudget> split(int count) const;
+    /**
+     * @brief merge adds the counters of a part given by split() and checks the limits on the totals.
+     * @param part
+     */
+    void merge(const EvaluationBudget& part);
+
+    /**
+     * @brief isExhausted is called for each die, so the clock is only read once every TIME_CHECK_PERIOD calls.
+     * @return true as soon as one limit has been crossed. The first limit crossed is kept.
+     */
+    bool isExhausted();
+    /**
+     * @brief getExhaustedLimit
+     * @return the limit which has been crossed or NONE.
+     */
+    EvaluationBudget::LIMIT getExhaustedLimit() const;
+    /**
+     * @brief getErrorMessage
+     * @return human readable explanation of the crossed limit.
+     */
+    QString getErrorMessage() const;
+
+    qint64 getMaxDice() const;
+    void setMaxDice(qint64 maxDice);
+
+    qint64 getMaxRolls() const;
+    void setMaxRolls(qint64 maxRolls);
+
+    qint64 getMaxNodes() const;
+    void setMaxNodes(qint64 maxNodes);
+
+    qint64 getMaxTime() const;
+    void setMaxTime(qint64 milliseconds);
+
+    qint64 getMaxBytes() const;
+    void setMaxBytes(qint64 maxBytes);
+
+    qint64 getDiceCount() const;
+    qint64 getRollCount() const;
+    qint64 getNodeCount() const;
+    qint64 getByteCount() const;
+
+private:
+    struct Shared;
+    void charge(EvaluationBudget::LIMIT limit, qint64& counter, qint64 count, qint64 max);
+    void check(EvaluationBudget::LIMIT limit, qint64 value, qint64 max);
+
+private:
+    qint64 m_maxDice;
+    qint64 m_maxRolls;
+    qint64 m_maxNodes;
+    qint64 m_maxTime;
+    qint64 m_maxBytes;
+
+    qint64 m_diceCount;
+    qint64 m_rollCount;
+    qint64 m_nodeCount;
+    qint64 m_byteCount;
+
+    EvaluationBudget::LIMIT m_exhausted;
+    std::chrono::steady_clock::time_point m_start;
+    quint32 m_timeChecks;
+    QSharedPointer<Shared> m_shared;
+};
+
+#endif // EVALUATIONBUDGET_H
@@ -0,0 +1,242 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include "executionprofiler.h"
+
+#include <QMap>
+#include <chrono>
+
+#include "evaluationbudget.h"
+#include "node/executionnode.h"
+
+namespace
+{
+thread_local ExecutionProfiler* s_current = nullptr;
+
+qint64 now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+void appendJsonString(QByteArray& out,const QString& text)
+{
+    out.append('"');
+    for(QChar c : text)
+    {
+        if((c == QLatin1Char('"'))||(c == QLatin1Char('\\')))
+        {
+            out.append('\\');
+            out.append(static_cast<char>(c.unicode()));
+        }
+        else if(c.unicode() < 0x20)
+        {
+            out.append(QStringLiteral("\\u%1").arg(c.unicode(),4,16,QLatin1Char('0')).toUtf8());
+        }
+        else
+        {
+            out.append(QString(c).toUtf8());
+        }
+    }
+    out.append('"');
+}
+}
+
+ExecutionProfiler::Scope::Scope(ExecutionProfiler* profiler)
+    : m_previous(s_current)
+{
+    s_current = profiler;
+}
+ExecutionProfiler::Scope::~Scope()
+{
+    s_current = m_previous;
+}
+
+ExecutionProfiler::ExecutionProfiler()
+    : m_track(0)
+{
+
+}
+ExecutionProfiler* ExecutionProfiler::current()
+{
+    return s_current;
+}
+void ExecutionProfiler::clear()
+{
+    m_events.clear();
+    m_openEvents.clear();
+    m_track = 0;
+}
+void ExecutionProfiler::setTrack(int track)
+{
+    m_track = track;
+}
+int ExecutionProfiler::beginNode(ExecutionNode* node)
+{
+    // the label of the dot tree: "NodeType details".
+    QString description = node->toString(true);
+    int start = description.indexOf(QStringLiteral("label=\""));
+    QString label;
+    if(start >= 0)
+    {
+        start += 7;
+        label = description.mid(start,description.indexOf(QLatin1Char('"'),start)-start);
+    }
+    QString name = label.section(QLatin1Char(' '),0,0);
+    return beginEvent(name.isEmpty() ? QStringLiteral("ExecutionNode") : name,label,node->getSourcePosition(),node->getSourceLength());
+}
+int ExecutionProfiler::beginEvent(const QString& name,const QString& label,int position,int length)
+{
+    Event event;
+    event.name = name;
+    event.label = label;
+    event.parent = m_openEvents.isEmpty() ? -1 : m_openEvents.last();
+    event.track = m_track;
+    event.position = position;
+    event.length = length;
+    EvaluationBudget* budget = EvaluationBudget::current();
+    event.dice = (nullptr!=budget) ? budget->getDiceCount() : 0;
+    event.rolls = (nullptr!=budget) ? budget->getRollCount() : 0;
+    event.bytes = (nullptr!=budget) ? budget->getByteCount() : 0;
+    event.duration = 0;
+    event.start = now();
+    m_events.append(event);
+    m_openEvents.append(m_events.size()-1);
+    return m_events.size()-1;
+}
+void ExecutionProfiler::endEvent(int index)
+{
+    qint64 end = now();
+    Event& event = m_events[index];
+    event.duration = end-event.start;
+    EvaluationBudget* budget = EvaluationBudget::current();
+    event.dice = (nullptr!=budget) ? budget->getDiceCount()-event.dice : 0;
+    event.rolls = (nullptr!=budget) ? budget->getRollCount()-event.rolls : 0;
+    event.bytes = (nullptr!=budget) ? budget->getByteCount()-event.bytes : 0;
+    while((!m_openEvents.isEmpty())&&(m_openEvents.last() >= index))
+    {
+        m_openEvents.removeLast();
+    }
+}
+void ExecutionProfiler::append(const ExecutionProfiler& other)
+{
+    const int offset = m_events.size();
+    for(Event event : other.m_events)
+    {
+        if(event.parent >= 0)
+        {
+            event.parent += offset;
+        }
+        m_events.append(event);
+    }
+}
+const QList<ExecutionProfiler::Event>& ExecutionProfiler::getEvents() const
+{
+    return m_events;
+}
+qint64 ExecutionProfiler::getTotalTime() const
+{
+    qint64 total = 0;
+    for(const Event& event : m_events)
+    {
+        if(event.parent < 0)
+        {
+            total += event.duration;
+        }
+    }
+    return total;
+}
+QByteArray ExecutionProfiler::toChromeTrace() const
+{
+    qint64 origin = 0;
+    for(int i = 0; i < m_events.size(); ++i)
+    {
+        if((i == 0)||(m_events.at(i).start < origin))
+        {
+            origin = m_events.at(i).start;
+        }
+    }
+    QByteArray out("{\"traceEvents\":[");
+    for(int i = 0; i < m_events.size(); ++i)
+    {
+        const Event& event = m_events.at(i);
+        if(i > 0)
+        {
+            out.append(',');
+        }
+        out.append("{\"name\":");
+        appendJsonString(out,event.name);
+        out.append(",\"cat\":\"node\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+        out.append(QByteArray::number(event.track));
+        out.append(",\"ts\":");
+        out.append(QByteArray::number((event.start-origin)/1000.0,'f',3));
+        out.append(",\"dur\":");
+        out.append(QByteArray::number(event.duration/1000.0,'f',3));
+        out.append(",\"args\":{\"label\":");
+        appendJsonString(out,event.label);
+        out.append(",\"dice\":");
+        out.append(QByteArray::number(event.dice));
+        out.append(",\"rolls\":");
+        out.append(QByteArray::number(event.rolls));
+        out.append(",\"bytes\":");
+        out.append(QByteArray::number(event.bytes));
+        out.append(",\"position\":");
+        out.append(QByteArray::number(event.position));
+        out.append(",\"length\":");
+        out.append(QByteArray::number(event.length));
+        out.append("}}");
+    }
+    out.append("],\"displayTimeUnit\":\"ns\"}");
+    return out;
+}
+QByteArray ExecutionProfiler::toFoldedStacks() const
+{
+    QList<qint64> selfTimes;
+    selfTimes.reserve(m_events.size());
+    for(const Event& event : m_events)
+    {
+        selfTimes.append(event.duration);
+    }
+    for(const Event& event : m_events)
+    {
+        if(event.parent >= 0)
+        {
+            selfTimes[event.parent] -= event.duration;
+        }
+    }
+    QMap<QString,qint64> stacks;
+    for(int i = 0; i < m_events.size(); ++i)
+    {
+        QString stack = m_events.at(i).name;
+        for(int parent = m_events.at(i).parent; parent >= 0; parent = m_events.at(parent).parent)
+        {
+            stack.prepend(m_events.at(parent).name+QLatin1Char(';'));
+        }
+        stacks[stack] += qMax<qint64>(0,selfTimes.at(i));
+    }
+    QByteArray out;
+    for(auto it = stacks.constBegin(); it != stacks.constEnd(); ++it)
+    {
+        out.append(it.key().toUtf8());
+        out.append(' ');
+        out.append(QByteArray::number(it.value()));
+        out.append('\n');
+    }
+    return out;
+}
@@ -0,0 +1,139 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef EXECUTIONPROFILER_H
+#define EXECUTIONPROFILER_H
+
+#include <QString>
+#include <QList>
+#include <QByteArray>
+
+class ExecutionNode;
+
+/**
+ * @brief The ExecutionProfiler class records the wall time, dice, rolls and memory of each node run.
+ *
+ * ExecutionNode::run() records one event around each node when a profiler is current on the calling thread. Events
+ * of nodes run by another node (parentheses, operators, if branches) are its children. Dice, rolls and bytes come
+ * from the current EvaluationBudget, they include the children. Events are named by the node type given in
+ * toString(true) and can be exported as a Chrome trace or as folded stacks for flame graphs.
+ */
+class ExecutionProfiler
+{
+public:
+    /**
+     * @brief The Scope class makes a profiler the current one for the calling thread until it is destroyed.
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(ExecutionProfiler* profiler);
+        ~Scope();
+    private:
+        ExecutionProfiler* m_previous;
+    };
+    /**
+     * @brief The Event struct, one node run. Times are in nanoseconds.
+     */
+    struct Event
+    {
+        QString name;
+        QString label;
+        int parent;
+        int track;
+        qint64 start;
+        qint64 duration;
+        qint64 dice;
+        qint64 rolls;
+        qint64 bytes;
+        int position;
+        int length;
+    };
+
+    /**
+     * @brief ExecutionProfiler
+     */
+    ExecutionProfiler();
+    /**
+     * @brief current
+     * @return the profiler active on the calling thread, nullptr when none.
+     */
+    static ExecutionProfiler* current();
+
+    /**
+     * @brief clear removes all events.
+     */
+    void clear();
+    /**
+     * @brief setTrack sets the track of the next events, the index of the instruction being run.
+     * @param track
+     */
+    void setTrack(int track);
+    /**
+     * @brief beginNode starts the event of a node.
+     * @param node
+     * @return index of the event, given to endEvent.
+     */
+    int beginNode(ExecutionNode* node);
+    /**
+     * @brief beginEvent starts an event which is not a node (a program run on DiceVm...).
+     * @return index of the event, given to endEvent.
+     */
+    int beginEvent(const QString& name,const QString& label,int position = -1,int length = 0);
+    /**
+     * @brief endEvent
+     * @param index
+     */
+    void endEvent(int index);
+    /**
+     * @brief append adds the events of another profiler, used to gather instructions run on other threads.
+     * @param other
+     */
+    void append(const ExecutionProfiler& other);
+
+    /**
+     * @brief getEvents
+     * @return events in order of start.
+     */
+    const QList<ExecutionProfiler::Event>& getEvents() const;
+    /**
+     * @brief getTotalTime
+     * @return sum of the durations of the top level events, in nanoseconds.
+     */
+    qint64 getTotalTime() const;
+    /**
+     * @brief toChromeTrace
+     * @return JSON trace for chrome://tracing or Perfetto, one thread per track (instruction).
+     */
+    QByteArray toChromeTrace() const;
+    /**
+     * @brief toFoldedStacks
+     * @return one line per stack of node types with its own time in nanoseconds, the input of flamegraph.pl.
+     */
+    QByteArray toFoldedStacks() const;
+
+private:
+    QList<ExecutionProfiler::Event> m_events;
+    QList<int> m_openEvents;
+    int m_track;
+};
+
+#endif // EXECUTIONPROFILER_H
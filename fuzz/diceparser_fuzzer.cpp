@@ -0,0 +1,100 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include <QByteArray>
+#include <QString>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "diceparser.h"
+#include "diceformatter.h"
+
+/**
+ * @page Fuzz
+ * libFuzzer target: each input is a command, parsed and run by DiceParser, then read and formatted as the
+ * front ends do. Crashes and sanitizer reports are found by libFuzzer. An input which needs more than
+ * DICE_FUZZ_SLOW_MS (default 1000) is aborted as a performance bug: the evaluation budget of the parser should have
+ * stopped it long before. Hangs and memory are bounded by libFuzzer itself (-timeout, -rss_limit_mb, -malloc_limit_mb).
+ */
+
+#define FUZZ_MAX_INPUT 4096
+#define FUZZ_MAX_TIME 100
+#define FUZZ_MAX_BYTES (32*1024*1024)
+
+namespace
+{
+qint64 s_slowTime = 1000;
+DiceParser* s_parser = nullptr;
+}
+
+extern "C" int LLVMFuzzerInitialize(int* argc,char*** argv)
+{
+    Q_UNUSED(argc);
+    Q_UNUSED(argv);
+    const char* slow = std::getenv("DICE_FUZZ_SLOW_MS");
+    if(nullptr!=slow)
+    {
+        s_slowTime = std::atoll(slow);
+    }
+    // one parser for all inputs as in the front ends: what a command leaves behind is exercised too.
+    s_parser = new DiceParser();
+    s_parser->getBudget()->setMaxTime(FUZZ_MAX_TIME);
+    s_parser->getBudget()->setMaxBytes(FUZZ_MAX_BYTES);
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data,size_t size)
+{
+    if(size > FUZZ_MAX_INPUT)
+    {
+        return 0;
+    }
+    QString command = QString::fromUtf8(reinterpret_cast<const char*>(data),static_cast<int>(size));
+    auto start = std::chrono::steady_clock::now();
+    if(s_parser->parseLine(command))
+    {
+        s_parser->Start();
+        QList<ExportedDiceResult> dice;
+        bool homogeneous = true;
+        bool hasAlias = false;
+        s_parser->getLastIntegerResults();
+        s_parser->getSumOfDiceResult();
+        s_parser->getStringResult();
+        s_parser->getAllDiceResult(hasAlias);
+        s_parser->getLastDiceResult(dice,homogeneous);
+        s_parser->displayResult();
+        QByteArray buffer;
+        DiceFormatter<JsonFormat> formatter(buffer);
+        formatter.format(*s_parser);
+    }
+    s_parser->humanReadableError();
+    qint64 elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-start).count();
+    if(elapsed > s_slowTime)
+    {
+        std::fprintf(stderr,"==DiceParser== performance bug: %lld ms for a budget of %d ms, dice: %lld, bytes: %lld\n",
+                     static_cast<long long>(elapsed),FUZZ_MAX_TIME,static_cast<long long>(s_parser->getBudget()->getDiceCount()),
+                     static_cast<long long>(s_parser->getBudget()->getByteCount()));
+        std::abort();
+    }
+    return 0;
+}
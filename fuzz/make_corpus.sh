@@ -0,0 +1,15 @@
+#!/bin/sh
+# Builds the seed corpus of the fuzzer: every command of cli/cmds.txt and every example of HelpMe.md, one per file.
+# usage: make_corpus.sh [corpus directory]
+
+ROOT=`dirname "$0"`/..
+CORPUS="${1:-corpus}"
+mkdir -p "$CORPUS"
+
+{
+  cat "$ROOT/cli/cmds.txt"
+  sed -n 's/^> //p' "$ROOT/HelpMe.md"
+} | sed 's/[[:space:]]*$//' | grep -v '^$' | sort -u | while IFS= read -r cmd
+do
+  printf '%s' "$cmd" > "$CORPUS/`printf '%s' "$cmd" | cksum | cut -d' ' -f1`"
+done
@@ -20,9 +20,10 @@
 * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
 ***************************************************************************/
 #include "botircdiceparser.h"
+#include "diceformatter.h"
+#include "dicelog.h"
 
 #include <math.h>
-#include <QDebug>
 #include <QString>
 
 BotIrcDiceParser::BotIrcDiceParser(QObject *parent) :
@@ -48,18 +49,18 @@ BotIrcDiceParser::~BotIrcDiceParser()
 }
 void BotIrcDiceParser::connectToServer()
 {
-    qDebug() << "start connection";
+    DICE_INFO(IRC) << "start connection";
     m_socket->connectToHost(QString("irc.freenode.net"), 8001);
 }
 void BotIrcDiceParser::errorOccurs(QAbstractSocket::SocketError)
 {
-    qDebug() << "ERROR" << m_socket->errorString();
+    DICE_WARNING(IRC) << "ERROR" << m_socket->errorString();
 }
 
 void BotIrcDiceParser::readData()
 {
 
-    qDebug() << "Reply";
+    DICE_DEBUG(IRC) << "Reply";
     QString readLine = m_socket->readLine();
 
     if(readLine.startsWith("!"))
@@ -77,7 +78,7 @@ void BotIrcDiceParser::readData()
 
 
         QStringList list = exp.capturedTexts();
-        qDebug()<<list;
+        DICE_DEBUG(IRC) << list;
         if(list.size()==2)
         {
             QString cmd = list[1];
@@ -144,7 +145,7 @@ void BotIrcDiceParser::disconnectFromServer()
 }
 void BotIrcDiceParser::authentificationProcess()
 {
-    qDebug() << "authentification";
+    DICE_INFO(IRC) << "authentification";
     m_socket->write(QLatin1String("NICK rolisteamDice \r\n").data());
     m_socket->write(QLatin1String("USER rolisteamDice rolisteamDice rolisteamDice :rolisteamDice BOT \r\n").data());
 
@@ -154,76 +155,12 @@ void BotIrcDiceParser::joinChannel()
 {
     m_socket->write(QLatin1String("JOIN #RolisteamOfficial \r\n").data());
 }
-QString BotIrcDiceParser::diceToText(QList<ExportedDiceResult>& diceList,bool highlight,bool homogeneous)
+QString BotIrcDiceParser::diceToText()
 {
-    QStringList global;
-    for(auto dice : diceList)
-    {
-        QStringList resultGlobal;
-        for(int face : dice.keys())
-        {
-            QStringList result;
-            ListDiceResult diceResult =  dice.value(face);
-            for (const auto& tmp : diceResult)
-            {
-                QStringList diceListStr;
-                QStringList diceListChildren;
-
-                for(int i =0; i < tmp.getResult().size(); ++i)
-                {
-                    qint64 dievalue = tmp.getResult()[i];
-                    QString prefix("%1");
-
-                    if((tmp.isHighlighted())&&(highlight))
-                    {
-                        if(tmp.getColor().isEmpty()|| tmp.getColor()=="black")
-                        {
-                            prefix = "%1";
-                        }
-                        if(tmp.getColor()=="white")
-                        {
-                            prefix = "%1";
-                        }
-                        if(tmp.getColor()=="blue")
-                        {
-                            prefix = "%1";
-                        }
-                        if(tmp.getColor()=="red")
-                        {
-                            prefix = "%1";
-                        }
-                    }
-
-                    if(i==0)
-                    {
-                        diceListStr << prefix.arg(QString::number(dievalue));
-                    }
-                    else
-                    {
-                        diceListChildren << prefix.arg(QString::number(dievalue));
-                    }
-                }
-                if(!diceListChildren.isEmpty())
-                {
-                    diceListStr << QString("[%1]").arg(diceListChildren.join(' '));
-                }
-
-                result << diceListStr.join(' ');
-                // qDebug() << result << tmp.first << tmp.second;
-            }
-
-            if(dice.keys().size()>1)
-            {
-                resultGlobal << QString(" d%2:(%1)").arg(result.join(',')).arg(face);
-            }
-            else
-            {
-                resultGlobal << result;
-            }
-        }
-        global << resultGlobal.join(' ');
-    }
-    return global.join(' ');
+    m_buffer.resize(0);
+    DiceFormatter<TextFormat> formatter(m_buffer,TextFormat(" "));
+    formatter.format(*m_parser);
+    return QString::fromUtf8(m_buffer);
 }
 
 QString BotIrcDiceParser::startDiceParsing(QString& cmd,bool highlight)
@@ -234,16 +171,13 @@ QString BotIrcDiceParser::startDiceParsing(QString& cmd,bool highlight)
     {
 
         m_parser->Start();
-        if(!m_parser->getErrorMap().isEmpty())
+        if(m_parser->hasExecutionError())
         {
             out << "Error" << m_parser->humanReadableError()<< "\n";
             return QString();
         }
 
-        QList<ExportedDiceResult> list;
-        bool homogeneous = true;
-        m_parser->getLastDiceResult(list,homogeneous);
-        QString diceText = diceToText(list,highlight,homogeneous);
+        QString diceText = diceToText();
         QString scalarText;
         QString str;
 
@@ -257,7 +191,7 @@ QString BotIrcDiceParser::startDiceParsing(QString& cmd,bool highlight)
             }
             scalarText = QString("%1").arg(strLst.join(','));
         }
-        else if(!list.isEmpty())
+        else if(m_parser->getStartNodeCount()>0)
         {
             auto values = m_parser->getSumOfDiceResult();
             QStringList strLst;
@@ -34,7 +34,7 @@ public:
     explicit BotIrcDiceParser(QObject *parent = 0);
     virtual ~BotIrcDiceParser();
 
-    QString diceToText(QList<ExportedDiceResult>& dice, bool highlight, bool homogeneous);
+    QString diceToText();
     QString startDiceParsing(QString &cmd, bool highlight);
 public slots:
     void errorOccurs(QAbstractSocket::SocketError);
@@ -43,6 +43,7 @@ private:
     //Ui::BotIrcDiceParser *ui;
     QTcpSocket * m_socket;
     DiceParser* m_parser;
+    QByteArray m_buffer;
 
 private slots:
      void readData();
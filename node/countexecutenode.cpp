@@ -1,5 +1,6 @@
 #include "countexecutenode.h"
 #include "result/diceresult.h"
+#include "result/dicehistogram.h"
 
 
 
@@ -12,6 +13,10 @@ void CountExecuteNode::setValidator(Validator* validator)
 {
 	m_validator = validator;
 }
+const Validator* CountExecuteNode::getValidator() const
+{
+    return m_validator;
+}
 CountExecuteNode::~CountExecuteNode()
 {
     if(nullptr!=m_validator)
@@ -20,34 +25,43 @@ CountExecuteNode::~CountExecuteNode()
 	}
 }
 
-void CountExecuteNode::run(ExecutionNode *previous)
+ExecutionNode* CountExecuteNode::execute(ExecutionNode *previous)
 {
 	m_previousNode = previous;
     if(nullptr==previous)
 	{
-		return;
+		return nullptr;
 	}
     DiceResult* previousResult = dynamic_cast<DiceResult*>(previous->getResult());
     if(NULL!=previousResult)
 	{
         m_result->setPrevious(previousResult);
-        QList<Die*> diceList=previousResult->getResultList();
+        QList<Die*> diceList=previousResult->getDiceList();
 		qint64 sum = 0;
-		foreach(Die* dice,diceList)
-		{
-            if(NULL!=m_validator)
+        DiceHistogram* histogram = previousResult->getHistogram();
+        if((nullptr!=m_validator)&&(nullptr!=histogram))
+        {
+            // homogeneous dice: the validator runs once per face, not once per die.
+            DiceHistogram evaluated(*histogram);
+            sum = evaluated.evaluate(m_validator,true,true);
+            evaluated.applyHighlight(diceList);
+        }
+        else
+        {
+            foreach(Die* dice,diceList)
             {
-                sum+=m_validator->hasValid(dice,true,true);
+                if(NULL!=m_validator)
+                {
+                    sum+=m_validator->hasValid(dice,true,true);
+                }
             }
-		}
+        }
 		m_scalarResult->setValue(sum);
 
 
-        if(nullptr!=m_nextNode)
-		{
-			m_nextNode->run(this);
-		}
+        return this;
 	}
+    return nullptr;
 }
 QString CountExecuteNode::toString(bool withlabel) const
 {
@@ -83,6 +97,7 @@ ExecutionNode* CountExecuteNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 
 }
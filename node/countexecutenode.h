@@ -18,14 +18,19 @@ public:
     CountExecuteNode();
 	virtual ~CountExecuteNode();
     /**
-     * @brief run
+     * @brief execute
      * @param previous
      */
-    virtual void run(ExecutionNode* previous);
+    virtual ExecutionNode* execute(ExecutionNode* previous);
     /**
      * @brief setValidator
      */
     virtual void setValidator(Validator* );
+    /**
+     * @brief getValidator
+     * @return the validator, still owned by this node.
+     */
+    const Validator* getValidator() const;
     /**
      * @brief toString
      * @return
@@ -1,5 +1,6 @@
 #include "dicerollernode.h"
 #include "die.h"
+#include "evaluationbudget.h"
 
 
 #include <QThread>
@@ -14,7 +15,7 @@ DiceRollerNode::DiceRollerNode(qint64 max,qint64 min)
 {
 	m_result=m_diceResult;
 }
-void DiceRollerNode::run(ExecutionNode* previous)
+ExecutionNode* DiceRollerNode::execute(ExecutionNode* previous)
 {
 	m_previousNode = previous;
     if(nullptr!=previous)
@@ -22,16 +23,35 @@ void DiceRollerNode::run(ExecutionNode* previous)
         Result* result=previous->getResult();
         if(nullptr!=result)
         {
-            m_diceCount = result->getResult(Result::SCALAR).toReal();
+            const qreal count = result->scalar();
             m_result->setPrevious(result);
 
+            if(count < 0)
+            {
+                // checked before the budget, which is only charged with counts of dice.
+                addError(NO_DICE_TO_ROLL,QObject::tr("Can't roll a negative number of dice: %1").arg(count));
+                return nullptr;
+            }
+            m_diceCount = static_cast<quint64>(count);
+            m_diceResult->clear();
             if(m_diceCount == 0)
             {
-                m_errors.insert(NO_DICE_TO_ROLL,QObject::tr("No dice to roll"));
+                addError(NO_DICE_TO_ROLL,QObject::tr("No dice to roll"));
+            }
+
+            EvaluationBudget* budget = EvaluationBudget::current();
+            if((nullptr!=budget)&&(!budget->allocateDice(static_cast<qint64>(m_diceCount))))
+            {
+                addError(BUDGET_EXCEEDED,budget->getErrorMessage());
+                return nullptr;
             }
 
             for(quint64 i=0; i < m_diceCount ; ++i)
             {
+                if(isBudgetExhausted())
+                {
+                    return nullptr;
+                }
                 Die* die = new Die();
                 die->setOp(m_operator);
                 die->setBase(m_min);
@@ -40,18 +60,24 @@ void DiceRollerNode::run(ExecutionNode* previous)
                 //qDebug() << die->getValue() << "value";
 				m_diceResult->insertResult(die);
             }
-            if(nullptr!=m_nextNode)
-            {
-                m_nextNode->run(this);
-            }
+            return this;
         }
 	}
+    return nullptr;
 }
 
 quint64 DiceRollerNode::getFaces() const
 {
     return abs(m_max-m_min)+1;
 }
+qint64 DiceRollerNode::getMinValue() const
+{
+    return m_min;
+}
+qint64 DiceRollerNode::getMaxValue() const
+{
+    return m_max;
+}
 QString DiceRollerNode::toString(bool wl) const
 {
 	if(wl)
@@ -79,6 +105,7 @@ ExecutionNode* DiceRollerNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 }
 
@@ -20,14 +20,24 @@ public:
     DiceRollerNode(qint64 max, qint64 min = 1);
 
 	/**
-	 * @brief run - starts to roll dice.
+	 * @brief execute - starts to roll dice.
 	 */
-    virtual void run(ExecutionNode*);
+    virtual ExecutionNode* execute(ExecutionNode* previous);
 	/**
 	 * @brief getFaces accessor
 	 * @return the face count
 	 */
     quint64 getFaces() const;
+    /**
+     * @brief getMinValue
+     * @return lowest face.
+     */
+    qint64 getMinValue() const;
+    /**
+     * @brief getMaxValue
+     * @return highest face.
+     */
+    qint64 getMaxValue() const;
 
 	/**
 	  * @brief toString
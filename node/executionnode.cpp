@@ -1,11 +1,21 @@
 #include "executionnode.h"
+#include "evaluationbudget.h"
+#include "diagnostics.h"
+#include "executionprofiler.h"
 
 #include <QUuid>
+#include <QVarLengthArray>
+
+#define CHAIN_STACK_SIZE 32
 
 ExecutionNode::ExecutionNode()
-    : m_previousNode(nullptr),m_result(nullptr),m_nextNode(nullptr),m_errors(QMap<ExecutionNode::DICE_ERROR_CODE,QString>()),m_id(QString("\"%1\"").arg(QUuid::createUuid().toString()))
+    : m_previousNode(nullptr),m_result(nullptr),m_nextNode(nullptr),m_errors(QMap<ExecutionNode::DICE_ERROR_CODE,QString>()),m_id(QString("\"%1\"").arg(QUuid::createUuid().toString())),m_sourcePosition(-1),m_sourceLength(0)
 {
-
+    EvaluationBudget* budget = EvaluationBudget::current();
+    if(nullptr!=budget)
+    {
+        budget->addNodes(1);
+    }
 }
 ExecutionNode::~ExecutionNode()
 {
@@ -21,6 +31,39 @@ ExecutionNode::~ExecutionNode()
 	}
 }
 
+void ExecutionNode::run(ExecutionNode* previous)
+{
+    QVarLengthArray<ExecutionNode*,CHAIN_STACK_SIZE> done;
+    ExecutionProfiler* profiler = ExecutionProfiler::current();
+    ExecutionNode* node = this;
+    while(nullptr!=node)
+    {
+        if(nullptr!=profiler)
+        {
+            int event = profiler->beginNode(node);
+            previous = node->execute(previous);
+            profiler->endEvent(event);
+        }
+        else
+        {
+            previous = node->execute(previous);
+        }
+        if(nullptr==previous)
+        {
+            break;
+        }
+        done.append(node);
+        node = node->m_nextNode;
+    }
+    for(int i = done.size()-1; i >= 0; --i)
+    {
+        done[i]->endChain();
+    }
+}
+void ExecutionNode::endChain()
+{
+
+}
 Result* ExecutionNode::getResult()
 {
     return m_result;
@@ -39,14 +82,63 @@ ExecutionNode* ExecutionNode::getNextNode()
 }
 QMap<ExecutionNode::DICE_ERROR_CODE,QString> ExecutionNode::getExecutionErrorMap()
 {
+    QMap<ExecutionNode::DICE_ERROR_CODE,QString> errors = m_errors;
     if(nullptr!=m_nextNode)
     {
-        for (const auto& key : m_nextNode->getExecutionErrorMap().keys())
+        const auto nextErrors = m_nextNode->getExecutionErrorMap();
+        for(auto it = nextErrors.constBegin(); it != nextErrors.constEnd(); ++it)
         {
-            m_errors.insert(key,m_nextNode->getExecutionErrorMap().value(key));
+            errors.insert(it.key(),it.value());
         }
     }
-    return m_errors;
+    return errors;
+}
+void ExecutionNode::addError(ExecutionNode::DICE_ERROR_CODE code,const QString& message)
+{
+    m_errors.insert(code,message);
+    Diagnostics* diagnostics = Diagnostics::current();
+    if(nullptr!=diagnostics)
+    {
+        diagnostics->addError(code,message,m_id,m_sourcePosition,m_sourceLength);
+    }
+}
+int ExecutionNode::getSourcePosition() const
+{
+    return m_sourcePosition;
+}
+int ExecutionNode::getSourceLength() const
+{
+    return m_sourceLength;
+}
+void ExecutionNode::setSourceSpan(int position,int length)
+{
+    m_sourcePosition = position;
+    m_sourceLength = length;
+}
+void ExecutionNode::addSourceSpan(const ExecutionNode* node)
+{
+    if((nullptr==node)||(node->m_sourcePosition < 0))
+    {
+        return;
+    }
+    if(m_sourcePosition < 0)
+    {
+        setSourceSpan(node->m_sourcePosition,node->m_sourceLength);
+        return;
+    }
+    int end = qMax(m_sourcePosition+m_sourceLength,node->m_sourcePosition+node->m_sourceLength);
+    m_sourcePosition = qMin(m_sourcePosition,node->m_sourcePosition);
+    m_sourceLength = end-m_sourcePosition;
+}
+bool ExecutionNode::isBudgetExhausted()
+{
+    EvaluationBudget* budget = EvaluationBudget::current();
+    if((nullptr!=budget)&&(budget->isExhausted()))
+    {
+        addError(BUDGET_EXCEEDED,budget->getErrorMessage());
+        return true;
+    }
+    return false;
 }
 QString ExecutionNode::getHelp()
 {
@@ -10,7 +10,7 @@
 class ExecutionNode
 {
 public:
-    enum DICE_ERROR_CODE {NO_DICE_ERROR,DIE_RESULT_EXPECTED,BAD_SYNTAXE,ENDLESS_LOOP_ERROR,DIVIDE_BY_ZERO,NOTHING_UNDERSTOOD,NO_DICE_TO_ROLL,TOO_MANY_DICE};
+    enum DICE_ERROR_CODE {NO_DICE_ERROR,DIE_RESULT_EXPECTED,BAD_SYNTAXE,ENDLESS_LOOP_ERROR,DIVIDE_BY_ZERO,NOTHING_UNDERSTOOD,NO_DICE_TO_ROLL,TOO_MANY_DICE,BUDGET_EXCEEDED};
     /**
      * @brief ExecutionNode
      */
@@ -20,10 +20,20 @@ public:
      */
     virtual ~ExecutionNode();
     /**
-     * @brief run
+     * @brief run runs this node and the next ones with a loop: the stack does not grow with the length of the chain.
+     * @param previous node before this one, nullptr for the first node of an instruction.
+     */
+    void run(ExecutionNode* previous = nullptr);
+    /**
+     * @brief execute does the work of this node only, run() calls it.
      * @param previous
+     * @return the node given as previous to the next node (usually this one), nullptr stops the chain.
      */
-    virtual void run(ExecutionNode* previous = nullptr)=0;
+    virtual ExecutionNode* execute(ExecutionNode* previous)=0;
+    /**
+     * @brief endChain is called once the nodes after this one have run, if this node did not stop the chain.
+     */
+    virtual void endChain();
     /**
      * @brief getResult
      * @return
@@ -59,6 +69,27 @@ public:
      * @return
      */
     virtual QMap<ExecutionNode::DICE_ERROR_CODE,QString> getExecutionErrorMap();
+    /**
+     * @brief getSourcePosition
+     * @return index in the command of the text this node comes from, -1 when unknown.
+     */
+    int getSourcePosition() const;
+    /**
+     * @brief getSourceLength
+     * @return length of the text this node comes from.
+     */
+    int getSourceLength() const;
+    /**
+     * @brief setSourceSpan is called by the parser where the token of the node is read, and by getCopy().
+     * @param position index in the command, -1 when unknown.
+     * @param length
+     */
+    void setSourceSpan(int position,int length);
+    /**
+     * @brief addSourceSpan extends the span to cover the one of another node, when nodes are folded or fused.
+     * @param node
+     */
+    void addSourceSpan(const ExecutionNode* node);
 
     /**
      * @brief generateDotTree
@@ -77,6 +108,19 @@ public:
      */
     virtual ExecutionNode* getCopy() const  = 0;
 
+protected:
+    /**
+     * @brief isBudgetExhausted checks the current evaluation budget, if any.
+     * @return true when the node must stop its work, the BUDGET_EXCEEDED error is then recorded.
+     */
+    bool isBudgetExhausted();
+    /**
+     * @brief addError records an error in this node and in the current diagnostics, if any.
+     * @param code
+     * @param message
+     */
+    void addError(ExecutionNode::DICE_ERROR_CODE code,const QString& message);
+
 protected:
 	/**
 	 * @brief m_nextNode
@@ -96,6 +140,8 @@ protected:
     QMap<ExecutionNode::DICE_ERROR_CODE,QString> m_errors;
 
 	QString m_id;
+    int m_sourcePosition;
+    int m_sourceLength;
 };
 
 #endif // EXECUTIONNODE_H
@@ -5,7 +5,7 @@ ExploseDiceNode::ExploseDiceNode()
 {
     m_result = m_diceResult;
 }
-void ExploseDiceNode::run(ExecutionNode* previous)
+ExecutionNode* ExploseDiceNode::execute(ExecutionNode* previous)
 {
 	m_previousNode = previous;
     if((NULL!=previous)&&(NULL!=previous->getResult()))
@@ -14,7 +14,8 @@ void ExploseDiceNode::run(ExecutionNode* previous)
         m_result->setPrevious(previous_result);
         if(NULL!=previous_result)
         {
-            foreach(Die* die,previous_result->getResultList())
+            m_diceResult->clear();
+            foreach(Die* die,previous_result->getDiceList())
             {
                 Die* tmpdie = new Die();
                 *tmpdie=*die;
@@ -29,17 +30,20 @@ void ExploseDiceNode::run(ExecutionNode* previous)
             {
                 while(m_validator->hasValid(die,false))
                 {
+                    if(isBudgetExhausted())
+                    {
+                        return nullptr;
+                    }
                     die->roll(true);
                 }
             }
+            m_diceResult->invalidateHistogram();
            // m_diceResult->setResultList(list);
 
-            if(NULL!=m_nextNode)
-            {
-                m_nextNode->run(this);
-            }
+            return this;
         }
     }
+    return nullptr;
 }
 ExploseDiceNode::~ExploseDiceNode()
 {
@@ -52,6 +56,10 @@ void ExploseDiceNode::setValidator(Validator* val)
 {
       m_validator = val;
 }
+const Validator* ExploseDiceNode::getValidator() const
+{
+    return m_validator;
+}
 QString ExploseDiceNode::toString(bool withlabel) const
 {
 	if(withlabel)
@@ -86,5 +94,6 @@ ExecutionNode* ExploseDiceNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 }
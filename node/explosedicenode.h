@@ -14,8 +14,9 @@ class ExploseDiceNode : public ExecutionNode
 public:
     ExploseDiceNode();
 	virtual ~ExploseDiceNode();
-    virtual void run(ExecutionNode* previous = nullptr);
+    virtual ExecutionNode* execute(ExecutionNode* previous);
     virtual void setValidator(Validator* );
+    const Validator* getValidator() const;
 	virtual QString toString(bool )const;
     virtual qint64 getPriority() const;
 
@@ -17,42 +17,63 @@ void FilterNode::setValidator(Validator* validator)
 {
     m_validator = validator;
 }
-void FilterNode::run(ExecutionNode* previous)
+const Validator* FilterNode::getValidator() const
+{
+    return m_validator;
+}
+ExecutionNode* FilterNode::execute(ExecutionNode* previous)
 {
     m_previousNode = previous;
     if(NULL==previous)
     {
-        return;
+        return nullptr;
     }
     DiceResult* previousDiceResult = static_cast<DiceResult*>(previous->getResult());
     m_result->setPrevious(previousDiceResult);
     if(NULL!=previousDiceResult)
     {
-        QList<Die*> diceList=previousDiceResult->getResultList();
+        QList<Die*> diceList=previousDiceResult->getDiceList();
         QList<Die*> diceList2;
 
-
-        for(Die* tmp : diceList)
+        // accepted dice are referenced without copy, they are displayed by this result.
+        DiceHistogram* histogram = previousDiceResult->getHistogram();
+        if(nullptr!=histogram)
         {
-            if(m_validator->hasValid(tmp,m_eachValue))
-            {
-                Die* tmpdie = new Die();
-                *tmpdie=*tmp;
-                diceList2.append(tmpdie);
-                tmp->displayed();
-            }
-            else
+            DiceHistogram evaluated(*histogram);
+            evaluated.evaluate(m_validator,m_eachValue,false);
+            evaluated.applyHighlight(diceList);
+            for(Die* tmp : diceList)
             {
-                tmp->setHighlighted(false);
+                if(evaluated.getValidity(tmp->getValue()))
+                {
+                    diceList2.append(tmp);
+                }
+                else
+                {
+                    tmp->setHighlighted(false);
+                }
             }
+            m_diceResult->setBorrowedResultList(diceList2);
+            m_diceResult->setHistogram(evaluated.getValidPart());
         }
-
-        m_diceResult->setResultList(diceList2);
-        if(NULL!=m_nextNode)
+        else
         {
-            m_nextNode->run(this);
+            for(Die* tmp : diceList)
+            {
+                if(m_validator->hasValid(tmp,m_eachValue))
+                {
+                    diceList2.append(tmp);
+                }
+                else
+                {
+                    tmp->setHighlighted(false);
+                }
+            }
+            m_diceResult->setBorrowedResultList(diceList2);
         }
+        return this;
     }
+    return nullptr;
 }
 
 QString FilterNode::toString(bool wl) const
@@ -88,5 +109,6 @@ ExecutionNode* FilterNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 }
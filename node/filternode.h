@@ -12,11 +12,16 @@ public:
     FilterNode();
     virtual ~FilterNode();
 
-    virtual void run(ExecutionNode* previous);
+    virtual ExecutionNode* execute(ExecutionNode* previous);
     /**
      * @brief setValidator
      */
     virtual void setValidator(Validator* );
+    /**
+     * @brief getValidator
+     * @return the validator, still owned by this node.
+     */
+    const Validator* getValidator() const;
     /**
      * @brief toString
      * @return
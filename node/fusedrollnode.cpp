@@ -0,0 +1,408 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include "fusedrollnode.h"
+
+#include <QVarLengthArray>
+#include <algorithm>
+#include <chrono>
+
+#include "evaluationbudget.h"
+#include "node/numbernode.h"
+#include "node/dicerollernode.h"
+#include "node/scalaroperatornode.h"
+#include "node/sortresult.h"
+#include "node/keepdiceexecnode.h"
+#include "node/countexecutenode.h"
+
+#define FUSED_STACK_SIZE 256
+#define MAX_FUSED_DICE (1<<24)
+#define MAX_FUSED_FACES 4096
+
+FusedRollNode::FusedRollNode(qint64 diceCount,qint64 min,qint64 max)
+    : m_kernel(SUM),m_diceCount(diceCount),m_min(min),m_max(max),m_operator(Die::PLUS),m_operand(0),m_keepCount(0),
+      m_ascending(false),m_validator(nullptr),m_diceResult(new DiceResult()),m_keptResult(nullptr),m_scalarResult(nullptr)
+{
+    m_result = m_diceResult;
+    auto seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    m_rng = std::mt19937(quintptr(this)+seed);
+}
+FusedRollNode::~FusedRollNode()
+{
+    // m_result is deleted by ExecutionNode, the other results of the chain are deleted here.
+    if(m_result != m_diceResult)
+    {
+        delete m_diceResult;
+    }
+    if((nullptr != m_keptResult)&&(m_result != m_keptResult))
+    {
+        delete m_keptResult;
+    }
+    if((nullptr != m_scalarResult)&&(m_result != m_scalarResult))
+    {
+        delete m_scalarResult;
+    }
+    if(nullptr != m_validator)
+    {
+        delete m_validator;
+    }
+}
+FusedRollNode* FusedRollNode::lower(ExecutionNode* first)
+{
+    NumberNode* number = dynamic_cast<NumberNode*>(first);
+    if(nullptr == number)
+    {
+        return nullptr;
+    }
+    DiceRollerNode* roller = dynamic_cast<DiceRollerNode*>(number->getNextNode());
+    if((nullptr == roller)||(roller->getOperator() != Die::PLUS))
+    {
+        return nullptr;
+    }
+    // errors (no dice, too many dice to keep...) are reported by the general nodes.
+    qint64 diceCount = number->getNumber();
+    qint64 min = roller->getMinValue();
+    qint64 max = roller->getMaxValue();
+    if((diceCount <= 0)||(diceCount > MAX_FUSED_DICE)||(min > max))
+    {
+        return nullptr;
+    }
+
+    ExecutionNode* tail = roller->getNextNode();
+    if(nullptr == tail)
+    {
+        return new FusedRollNode(diceCount,min,max);
+    }
+    if(nullptr != tail->getNextNode())
+    {
+        if(SortResultNode* sort = dynamic_cast<SortResultNode*>(tail))
+        {
+            KeepDiceExecNode* keep = dynamic_cast<KeepDiceExecNode*>(sort->getNextNode());
+            if((nullptr != keep)&&(nullptr == keep->getNextNode())&&(keep->getDiceKeepNumber() <= static_cast<quint64>(diceCount))
+                    &&(roller->getFaces() <= MAX_FUSED_FACES))
+            {
+                FusedRollNode* fused = new FusedRollNode(diceCount,min,max);
+                fused->setKeep(static_cast<qint64>(keep->getDiceKeepNumber()),sort->isAscending());
+                return fused;
+            }
+        }
+        return nullptr;
+    }
+    if(ScalarOperatorNode* op = dynamic_cast<ScalarOperatorNode*>(tail))
+    {
+        NumberNode* operand = dynamic_cast<NumberNode*>(op->getInternalNode());
+        if((nullptr == operand)||(nullptr != operand->getNextNode()))
+        {
+            return nullptr;
+        }
+        Die::ArithmeticOperator arithmetic = op->getArithmeticOperator();
+        bool supported = (arithmetic == Die::PLUS)||(arithmetic == Die::MINUS)||(arithmetic == Die::MULTIPLICATION)
+                ||((arithmetic == Die::DIVIDE)&&(operand->getNumber() != 0));
+        if(!supported)
+        {
+            return nullptr;
+        }
+        FusedRollNode* fused = new FusedRollNode(diceCount,min,max);
+        fused->setScalarOperator(arithmetic,operand->getNumber());
+        return fused;
+    }
+    if(CountExecuteNode* count = dynamic_cast<CountExecuteNode*>(tail))
+    {
+        if((nullptr == count->getValidator())||(roller->getFaces() > MAX_FUSED_FACES))
+        {
+            return nullptr;
+        }
+        FusedRollNode* fused = new FusedRollNode(diceCount,min,max);
+        fused->setCount(count->getValidator()->getCopy());
+        return fused;
+    }
+    return nullptr;
+}
+void FusedRollNode::setScalarOperator(Die::ArithmeticOperator op,qint64 operand)
+{
+    m_kernel = SCALAR;
+    m_operator = op;
+    m_operand = operand;
+    if(nullptr == m_scalarResult)
+    {
+        m_scalarResult = new ScalarResult();
+    }
+    // like ScalarOperatorNode, the scalar result is not linked to the dice.
+    m_scalarResult->setPrevious(nullptr);
+    m_result = m_scalarResult;
+}
+void FusedRollNode::setKeep(qint64 count,bool ascending)
+{
+    m_kernel = KEEP;
+    m_keepCount = count;
+    m_ascending = ascending;
+    if(nullptr == m_keptResult)
+    {
+        m_keptResult = new DiceResult();
+    }
+    m_keptResult->setPrevious(m_diceResult);
+    m_result = m_keptResult;
+}
+void FusedRollNode::setCount(Validator* validator)
+{
+    m_kernel = COUNT;
+    if(nullptr != m_validator)
+    {
+        delete m_validator;
+    }
+    m_validator = validator;
+    if(nullptr == m_scalarResult)
+    {
+        m_scalarResult = new ScalarResult();
+    }
+    m_scalarResult->setPrevious(m_diceResult);
+    m_result = m_scalarResult;
+}
+FusedRollNode::KERNEL FusedRollNode::getKernel() const
+{
+    return m_kernel;
+}
+qint64 FusedRollNode::getDiceCount() const
+{
+    return m_diceCount;
+}
+qint64 FusedRollNode::getMinValue() const
+{
+    return m_min;
+}
+qint64 FusedRollNode::getMaxValue() const
+{
+    return m_max;
+}
+Die::ArithmeticOperator FusedRollNode::getScalarOperator() const
+{
+    return m_operator;
+}
+qint64 FusedRollNode::getOperand() const
+{
+    return m_operand;
+}
+qint64 FusedRollNode::getKeepCount() const
+{
+    return m_keepCount;
+}
+bool FusedRollNode::isAscending() const
+{
+    return m_ascending;
+}
+const Validator* FusedRollNode::getValidator() const
+{
+    return m_validator;
+}
+ExecutionNode* FusedRollNode::execute(ExecutionNode* previous)
+{
+    m_previousNode = previous;
+    if(nullptr != previous)
+    {
+        m_diceResult->setPrevious(previous->getResult());
+    }
+
+    EvaluationBudget* budget = EvaluationBudget::current();
+    if(nullptr != budget)
+    {
+        if(!budget->allocateDice(m_diceCount))
+        {
+            addError(BUDGET_EXCEEDED,budget->getErrorMessage());
+            return nullptr;
+        }
+        budget->addRolls(m_diceCount);
+        if(m_kernel != SCALAR)
+        {
+            budget->addBytes(m_diceCount*sizeof(Die));
+        }
+    }
+    if(isBudgetExhausted())
+    {
+        return nullptr;
+    }
+
+    const int size = static_cast<int>(m_diceCount);
+    QVarLengthArray<qint64,FUSED_STACK_SIZE> values(size);
+    std::uniform_int_distribution<qint64> dist(m_min,m_max);
+    std::mt19937& rng = (nullptr != Die::currentGenerator()) ? *Die::currentGenerator() : m_rng;
+    qint64 sum = 0;
+    for(int i = 0; i < size; ++i)
+    {
+        values[i] = dist(rng);
+        sum += values[i];
+    }
+
+    QList<Die*> dice;
+    switch(m_kernel)
+    {
+    case SCALAR:
+        // the dice cannot be reached from the scalar result, they are not created.
+        break;
+    case SUM:
+        for(int i = 0; i < size; ++i)
+        {
+            dice.append(createDie(values[i]));
+        }
+        break;
+    case KEEP:
+    {
+        // counting sort over the faces, the kept dice are the first ones of the sorted pool.
+        const int faces = static_cast<int>(m_max-m_min+1);
+        QVarLengthArray<int,FUSED_STACK_SIZE> counts(faces);
+        std::fill(counts.begin(),counts.end(),0);
+        for(int i = 0; i < size; ++i)
+        {
+            ++counts[static_cast<int>(values[i]-m_min)];
+        }
+        int index = 0;
+        for(int f = 0; f < faces; ++f)
+        {
+            int face = m_ascending ? f : faces-1-f;
+            qint64 value = m_min+face;
+            for(int n = counts[face]; n > 0; --n)
+            {
+                Die* die = createDie(value);
+                if(index >= m_keepCount)
+                {
+                    die->setHighlighted(false);
+                }
+                dice.append(die);
+                ++index;
+            }
+        }
+    }
+        break;
+    case COUNT:
+    {
+        // the validator is checked once per distinct value, -1 marks a value not checked yet.
+        const int faces = static_cast<int>(m_max-m_min+1);
+        QVarLengthArray<qint64,FUSED_STACK_SIZE> validity(faces);
+        QVarLengthArray<bool,FUSED_STACK_SIZE> highlight(faces);
+        std::fill(validity.begin(),validity.end(),-1);
+        Die probe;
+        probe.setBase(m_min);
+        probe.setMaxValue(m_max);
+        probe.insertRollValue(m_min);
+        sum = 0;
+        for(int i = 0; i < size; ++i)
+        {
+            int face = static_cast<int>(values[i]-m_min);
+            if(validity[face] < 0)
+            {
+                probe.replaceLastValue(values[i]);
+                probe.setHighlighted(true);
+                validity[face] = m_validator->hasValid(&probe,true,true);
+                highlight[face] = probe.isHighlighted();
+            }
+            sum += validity[face];
+            Die* die = createDie(values[i]);
+            die->setHighlighted(highlight[face]);
+            dice.append(die);
+        }
+    }
+        break;
+    }
+    if(m_kernel != SCALAR)
+    {
+        m_diceResult->setResultList(dice);
+    }
+
+    switch(m_kernel)
+    {
+    case SUM:
+        break;
+    case SCALAR:
+        switch(m_operator)
+        {
+        case Die::PLUS:
+            m_scalarResult->setValue(sum+m_operand);
+            break;
+        case Die::MINUS:
+            m_scalarResult->setValue(sum-m_operand);
+            break;
+        case Die::MULTIPLICATION:
+            m_scalarResult->setValue(sum*m_operand);
+            break;
+        case Die::DIVIDE:
+            m_scalarResult->setValue(static_cast<qreal>(sum)/m_operand);
+            break;
+        default:
+            break;
+        }
+        break;
+    case KEEP:
+        m_keptResult->setBorrowedResultList(dice.mid(0,static_cast<int>(m_keepCount)));
+        break;
+    case COUNT:
+        m_scalarResult->setValue(sum);
+        break;
+    }
+
+    return this;
+}
+Die* FusedRollNode::createDie(qint64 value) const
+{
+    Die* die = new Die();
+    die->setBase(m_min);
+    die->setMaxValue(m_max);
+    die->insertRollValue(value);
+    return die;
+}
+QString FusedRollNode::toString(bool withLabel) const
+{
+    if(withLabel)
+    {
+        static const char* kernels[] = {"sum","scalar","keep","count"};
+        return QString("%1 [label=\"FusedRollNode %2 %3d[%4..%5]\"]").arg(m_id).arg(kernels[m_kernel]).arg(m_diceCount).arg(m_min).arg(m_max);
+    }
+    else
+    {
+        return m_id;
+    }
+}
+qint64 FusedRollNode::getPriority() const
+{
+    return 4;
+}
+ExecutionNode* FusedRollNode::getCopy() const
+{
+    FusedRollNode* node = new FusedRollNode(m_diceCount,m_min,m_max);
+    switch(m_kernel)
+    {
+    case SUM:
+        break;
+    case SCALAR:
+        node->setScalarOperator(m_operator,m_operand);
+        break;
+    case KEEP:
+        node->setKeep(m_keepCount,m_ascending);
+        break;
+    case COUNT:
+        node->setCount(m_validator->getCopy());
+        break;
+    }
+    if(nullptr != m_nextNode)
+    {
+        node->setNextNode(m_nextNode->getCopy());
+    }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
+    return node;
+}
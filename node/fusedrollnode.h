@@ -0,0 +1,115 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef FUSEDROLLNODE_H
+#define FUSEDROLLNODE_H
+
+#include <random>
+
+#include "executionnode.h"
+#include "validator.h"
+#include "result/diceresult.h"
+#include "result/scalarresult.h"
+
+/**
+ * @brief The FusedRollNode class runs a whole common instruction in one node: NdX, NdX+K, NdXkY and NdXc[cond].
+ *
+ * Values are rolled into a stack buffer and the sum, keep or count is computed in the same pass, without any
+ * intermediate node or result. Dice are only created once at the end, so results can be displayed as usual,
+ * NdX+K does not create them at all since ScalarOperatorNode does not link its result to the dice.
+ * Use lower() to replace a chain, any other chain keeps the general nodes.
+ */
+class FusedRollNode : public ExecutionNode
+{
+public:
+    /**
+     * @brief The KERNEL enum lists the supported chains.
+     */
+    enum KERNEL {SUM,SCALAR,KEEP,COUNT};
+    /**
+     * @brief FusedRollNode rolls diceCount dice between min and max and sums them.
+     */
+    FusedRollNode(qint64 diceCount,qint64 min,qint64 max);
+    virtual ~FusedRollNode();
+    /**
+     * @brief lower builds the fused node equivalent to the chain starting at first.
+     * @param first NumberNode followed by a DiceRollerNode and at most one supported operation.
+     * @return the new node, or nullptr when the chain is not supported. The chain is not modified.
+     */
+    static FusedRollNode* lower(ExecutionNode* first);
+
+    /**
+     * @brief setScalarOperator applies op with operand to the sum of dice.
+     */
+    void setScalarOperator(Die::ArithmeticOperator op,qint64 operand);
+    /**
+     * @brief setKeep keeps the count highest dice, or the lowest ones when ascending.
+     */
+    void setKeep(qint64 count,bool ascending);
+    /**
+     * @brief setCount counts the dice accepted by the validator, the node takes its ownership.
+     */
+    void setCount(Validator* validator);
+    /**
+     * @brief getKernel
+     * @return
+     */
+    FusedRollNode::KERNEL getKernel() const;
+
+    qint64 getDiceCount() const;
+    qint64 getMinValue() const;
+    qint64 getMaxValue() const;
+    Die::ArithmeticOperator getScalarOperator() const;
+    qint64 getOperand() const;
+    qint64 getKeepCount() const;
+    bool isAscending() const;
+    /**
+     * @brief getValidator
+     * @return the validator of the count kernel, still owned by this node.
+     */
+    const Validator* getValidator() const;
+
+    virtual ExecutionNode* execute(ExecutionNode* previous);
+    virtual QString toString(bool withLabel)const;
+    virtual qint64 getPriority() const;
+    virtual ExecutionNode* getCopy() const;
+
+private:
+    Die* createDie(qint64 value) const;
+
+private:
+    KERNEL m_kernel;
+    qint64 m_diceCount;
+    qint64 m_min;
+    qint64 m_max;
+    Die::ArithmeticOperator m_operator;
+    qint64 m_operand;
+    qint64 m_keepCount;
+    bool m_ascending;
+    Validator* m_validator;
+
+    DiceResult* m_diceResult;
+    DiceResult* m_keptResult;
+    ScalarResult* m_scalarResult;
+    std::mt19937 m_rng;
+};
+
+#endif // FUSEDROLLNODE_H
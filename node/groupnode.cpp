@@ -21,6 +21,9 @@
 ***************************************************************************/
 #include "groupnode.h"
 #include "result/diceresult.h"
+#include "evaluationbudget.h"
+
+#include <algorithm>
 //-------------------------------
 int DieGroup::getSum() const
 {
@@ -64,7 +67,7 @@ GroupNode::GroupNode()
 {
     m_result = m_scalarResult;
 }
-void GroupNode::run(ExecutionNode* previous)
+ExecutionNode* GroupNode::execute(ExecutionNode* previous)
 {
     m_previousNode = previous;
     if(nullptr != previous)
@@ -76,36 +79,28 @@ void GroupNode::run(ExecutionNode* previous)
             DiceResult* dice = dynamic_cast<DiceResult*>(tmpResult);
             if(nullptr != dice)
             {
-                auto list = dice->getResultList();
                 DieGroup allResult;
-                for(Die* die : dice->getResultList())
+                for(Die* die : dice->getDiceList())
                 {
                     allResult << die->getListValue();
                 }
-                std::sort(allResult.begin(),allResult.end(), std::greater<qint64>());
-                if(allResult.getSum() > m_groupValue)
-                {
-                    auto const die =getGroup(allResult);
-                    m_scalarResult->setValue(die.size());
-                }
-                else
+                m_groupsList = getGroup(allResult);
+                if(isBudgetExhausted())
                 {
-                    m_scalarResult->setValue(0);
+                    return nullptr;
                 }
+                m_scalarResult->setValue(m_groupsList.size());
             }
         }
     }
-    if(nullptr!=m_nextNode)
-    {
-        m_nextNode->run(this);
-    }
+    return this;
 }
 
 QString GroupNode::toString(bool withLabel) const
 {
     if(withLabel)
     {
-        return QString("%1 [label=\"SplitNode Node\"]").arg(m_id);
+        return QString("%1 [label=\"GroupNode\"]").arg(m_id);
     }
     else
     {
@@ -124,10 +119,12 @@ qint64 GroupNode::getPriority() const
 ExecutionNode* GroupNode::getCopy() const
 {
     GroupNode* node = new GroupNode();
+    node->setGroupValue(m_groupValue);
     if(nullptr!=m_nextNode)
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 
 }
@@ -142,134 +139,162 @@ void GroupNode::setGroupValue(qint64 groupValue)
     m_groupValue = groupValue;
 }
 
-bool GroupNode::composeWithPrevious(DieGroup previous, qint64 first, qint64 current, DieGroup& addValue)
+QList<DieGroup> GroupNode::getGroup(DieGroup values)
 {
-    if(previous.getSum()+first+current == m_groupValue)
+    QList<DieGroup> result;
+    DieGroup smallValues;
+    for(auto value : values)
     {
-        addValue.append(previous);
-        addValue.append(first);
-        addValue.append(current);
-        return true;
+        if(value >= m_groupValue)
+        {
+            // a die reaching the target alone is always a group on its own.
+            DieGroup group;
+            group << value;
+            result << group;
+        }
+        else if(value > 0)
+        {
+            smallValues << value;
+        }
     }
+    if(smallValues.isEmpty())
+        return result;
 
-    if(previous.isEmpty())
-        return false;
-
-    int maxComboLength = previous.size();
-    bool hasReachMax = false;
-
-    QList<DieGroup> possibleUnion;
-    for(auto va : previous)
-    {
-        DieGroup dieG;
-        dieG.append(va);
-        possibleUnion.append(dieG);
-    }
-    while(!hasReachMax)
+    std::sort(smallValues.begin(),smallValues.end(), std::greater<qint64>());
+    m_values.clear();
+    m_failures.clear();
+    std::vector<int> counts;
+    for(auto value : smallValues)
     {
-        auto tmpValues = previous;
-        QList<DieGroup> possibleTmp;
-        for(auto& diaG : possibleUnion)
+        if(m_values.empty() || m_values.back() != value)
         {
-            tmpValues.removeValue(diaG);
-            for(auto& value : tmpValues)
-            {
-                DieGroup dia;
-                dia.append(diaG);
-                dia.append(value);
-                possibleTmp.append(dia);
-                if(dia.size() >= maxComboLength-1)
-                    hasReachMax = true;
-            }
+            m_values.push_back(value);
+            counts.push_back(0);
         }
-        if(possibleTmp.isEmpty())
-            hasReachMax = true;
-        possibleUnion.append(possibleTmp);
+        ++counts.back();
+    }
 
+    // Upper bounds: the whole sum and, as every group needs two dice at least, half of the dice.
+    qint64 sum = smallValues.getSum();
+    int need = static_cast<int>(std::min<qint64>(sum/m_groupValue, smallValues.size()/2));
+    QList<DieGroup> groups;
+    while((need > 0) && !composeGroups(counts, need, sum-need*m_groupValue, smallValues.size(), groups))
+    {
+        if(isBudgetExhausted())
+            return result;
+        --need;
     }
-    std::sort(possibleUnion.begin(),possibleUnion.end(),[=](const DieGroup& a, const DieGroup& b){
-        return a.getLost() > b.getLost();
-    });
-    bool found = false;
-    for(int i = 0;(!found && i < possibleUnion.size()); ++i)
+    result.append(groups);
+    return result;
+}
+
+bool GroupNode::composeGroups(std::vector<int>& counts, int need, qint64 slack, int count, QList<DieGroup>& groups)
+{
+    if(need == 0)
+        return true;
+
+    if((slack < 0) || (count < 2*need) || (3*need > count + getMaxPairs(counts)))
+        return false;
+
+    auto failure = m_failures.find(counts);
+    if((failure != m_failures.end()) && (need >= failure->second))
+        return false;
+
+    if(isBudgetExhausted())
+        return false;
+
+    // The biggest value belongs to a group in at least one best solution.
+    std::size_t first = 0;
+    while(counts[first] == 0)
+        ++first;
+
+    DieGroup group;
+    group << m_values[first];
+    --counts[first];
+    qint64 missing = m_groupValue - m_values[first];
+    bool found = closeGroup(counts, first, missing, missing+slack, slack, need, count-1, group, groups);
+    ++counts[first];
+
+    if(!found)
     {
-        auto& value = possibleUnion.at(i);
-        if(value.getSum() + current + first >= m_groupValue)
-        {
-            addValue << value << current << first;
-            found = true;
-        }
+        int& failedNeed = m_failures[counts];
+        if((failedNeed == 0) || (need < failedNeed))
+            failedNeed = need;
     }
     return found;
 }
 
-QList<DieGroup> GroupNode::getGroup(DieGroup values)
+bool GroupNode::closeGroup(std::vector<int>& counts, std::size_t from, qint64 missing, qint64 cap, qint64 slack, int need, int count, DieGroup& group, QList<DieGroup>& groups)
 {
-    auto first = values.takeFirst();
-
-    if(values.isEmpty())
-        return QList<DieGroup>();
+    if(cap < missing)
+        return false;
 
-    QList<DieGroup> result;
-    QMap<qint64,DieGroup> loseMap;
-    if(first == m_groupValue)
+    // Best fit: the smallest value closing the group dominates every completion with a greater sum.
+    std::size_t fit = counts.size();
+    for(std::size_t i = counts.size(); i > from; --i)
     {
-        DieGroup group;
-        group << first ;
-        loseMap[0] = group;
+        if((counts[i-1] > 0) && (m_values[i-1] >= missing))
+        {
+            fit = i-1;
+            break;
+        }
     }
-    else
+    if(fit < counts.size())
     {
-        DieGroup::reverse_iterator it = values.rbegin();
-        bool foundPerfect = false;
-        qint64 cumuledValue = 0;
-        DieGroup previousValue;
-        while((values.rend() != it) && !foundPerfect)
+        if(m_values[fit] <= cap)
         {
-            if(first+*it == m_groupValue)
+            --counts[fit];
+            bool found = composeGroups(counts, need-1, slack-(m_values[fit]-missing), count-1, groups);
+            ++counts[fit];
+            if(found)
             {
-                foundPerfect = true;
-                DieGroup group;
-                group << first << *it;
-                loseMap[0] = group;
+                group << m_values[fit];
+                groups << group;
+                return true;
             }
-            else if(first+*it > m_groupValue)
-            {
-                DieGroup group;
-                group << first << *it;
-                loseMap[first+*it-m_groupValue]=group;
-            }
-            else if(first+*it+cumuledValue == m_groupValue)
-            {
-                DieGroup group;
-                group << first << *it << previousValue;
-                foundPerfect = true;
-                loseMap[0] = group;
-            }
-            else if(first+*it+cumuledValue > m_groupValue)
-            {
-                DieGroup group;
-                group.setExceptedValue(m_groupValue);
-                composeWithPrevious(previousValue,first, *it, group);
-                loseMap[group.getLost()]= group;
-            }
-            previousValue << *it;
-            cumuledValue += *it;
-            ++it;
+            cap = m_values[fit]-1;
         }
+        from = fit+1;
     }
-    DieGroup die = loseMap.first();
-    result.append(die);
-    DieGroup valueToRemove = die;
-    valueToRemove.removeFirst();
-    values.removeValue(valueToRemove);
 
-    if(values.getSum() >= m_groupValue)
+    for(std::size_t i = from; i < counts.size(); ++i)
     {
-        result.append(getGroup(values));
-    }
-    return result;
+        if((counts[i] == 0) || (m_values[i] > cap))
+            continue;
 
+        --counts[i];
+        group << m_values[i];
+        bool found = closeGroup(counts, i, missing-m_values[i], cap-m_values[i], slack, need, count-1, group, groups);
+        group.removeLast();
+        ++counts[i];
+        if(found)
+            return true;
+    }
+    return false;
 }
 
+int GroupNode::getMaxPairs(const std::vector<int>& counts) const
+{
+    // pairs the biggest remaining value with the smallest one able to reach the target.
+    std::vector<int> remaining(counts);
+    int pairs = 0;
+    int big = 0;
+    int small = static_cast<int>(remaining.size())-1;
+    while(true)
+    {
+        while((big < static_cast<int>(remaining.size())) && (remaining[big] == 0))
+            ++big;
+        while((small >= 0) && (remaining[small] == 0))
+            --small;
+        if((big >= static_cast<int>(remaining.size())) || (small < big) || ((small == big) && (remaining[big] < 2)))
+            break;
 
+        if(m_values[big]+m_values[small] >= m_groupValue)
+        {
+            --remaining[big];
+            ++pairs;
+        }
+        --remaining[small];
+    }
+    return pairs;
+}
@@ -24,6 +24,9 @@
 
 #include "node/executionnode.h"
 #include "result/scalarresult.h"
+
+#include <map>
+#include <vector>
 //typedef QList<qint64> DieGroup;
 
 class DieGroup : public QList<qint64>
@@ -38,7 +41,7 @@ public:
     void setExceptedValue(qint64 exceptedValue);
 
 private:
-    qint64 m_exceptedValue;
+    qint64 m_exceptedValue = 0;
 
 };
 /**
@@ -48,7 +51,7 @@ class GroupNode : public ExecutionNode
 {
 public:
     GroupNode();
-    void run(ExecutionNode* previous);
+    ExecutionNode* execute(ExecutionNode* previous);
     virtual QString toString(bool withLabel)const;
     virtual qint64 getPriority() const;
     virtual ExecutionNode *getCopy() const;
@@ -56,13 +59,33 @@ public:
     int getGroupValue() const;
     void setGroupValue(qint64 groupValue);
 
-    QList<DieGroup> getGroup(DieGroup);
+    /**
+     * @brief getGroup computes the greatest number of groups whose sums reach the group value.
+     * @param values all die values.
+     * @return the groups, each value is used at most once.
+     */
+    QList<DieGroup> getGroup(DieGroup values);
 protected:
-    bool composeWithPrevious(DieGroup previous, qint64 first, qint64 current, DieGroup& addValue);
+    /**
+     * @brief composeGroups branch and bound search: can the values described by counts make need groups?
+     * @param slack sum of the values minus need times the group value, what the groups may waste.
+     */
+    bool composeGroups(std::vector<int>& counts, int need, qint64 slack, int count, QList<DieGroup>& groups);
+    /**
+     * @brief closeGroup completes group with values from index from, its extra values must not sum above cap.
+     */
+    bool closeGroup(std::vector<int>& counts, std::size_t from, qint64 missing, qint64 cap, qint64 slack, int need, int count, DieGroup& group, QList<DieGroup>& groups);
+    /**
+     * @brief getMaxPairs
+     * @return the greatest number of disjoint pairs reaching the group value.
+     */
+    int getMaxPairs(const std::vector<int>& counts) const;
 private:
     ScalarResult* m_scalarResult;
     qint64 m_groupValue;
     QList<DieGroup> m_groupsList;
+    std::vector<qint64> m_values;
+    std::map<std::vector<int>,int> m_failures;
 };
 
 #endif // GROUPNODE_H
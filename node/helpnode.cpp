@@ -24,7 +24,7 @@ HelpNode::HelpNode()
 {
     m_result = new StringResult();
 }
-void HelpNode::run(ExecutionNode* previous)
+ExecutionNode* HelpNode::execute(ExecutionNode* previous)
 {
 	m_previousNode = previous;
     StringResult* txtResult = dynamic_cast<StringResult*>(m_result);
@@ -43,10 +43,7 @@ void HelpNode::run(ExecutionNode* previous)
         m_result->setPrevious(previous->getResult());
     }
 
-    if(nullptr!=m_nextNode)
-    {
-        m_nextNode->run(this);
-    }
+    return this;
 }
 QString HelpNode::toString(bool wl) const
 {
@@ -76,5 +73,6 @@ ExecutionNode* HelpNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 }
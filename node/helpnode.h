@@ -37,10 +37,10 @@ public:
      */
     HelpNode();
     /**
-     * @brief run
+     * @brief execute
      * @param previous
      */
-    void run(ExecutionNode* previous);
+    ExecutionNode* execute(ExecutionNode* previous);
     /**
      * @brief toString
      * @return
@@ -29,109 +29,132 @@ IfNode::IfNode()
 IfNode::~IfNode()
 {
     m_result=nullptr;
+    qDeleteAll(m_frames);
 }
 
-void IfNode::run(ExecutionNode *previous)
+ExecutionNode* IfNode::execute(ExecutionNode *previous)
 {
     m_previousNode = previous;
     if(nullptr==previous)
     {
-        return;
+        return nullptr;
     }
     ExecutionNode* previousLoop = previous;
     ExecutionNode* nextNode = nullptr;
     bool runNext = (nullptr==m_nextNode) ? false : true;
     Result* previousResult = previous->getResult();
     m_result = previousResult;
+    // the frames of the last run are freed: the nodes after this one read the frames of this run.
+    qDeleteAll(m_frames);
+    m_frames.clear();
 
     if(nullptr!=m_result)
     {
-        qreal value = previousResult->getResult(Result::SCALAR).toReal();
+        qreal value = previousResult->scalar();
 
         if(nullptr!=m_validator)
         {
             DiceResult* previousDiceResult = dynamic_cast<DiceResult*>(previousResult);
             if(nullptr!=previousDiceResult)
             {
-                QList<Die*> diceList=previousDiceResult->getResultList();
+                QList<Die*> diceList=previousDiceResult->getDiceList();
 
                 if(m_conditionType == OnEach)
                 {
+                    // the validator is evaluated once per face for homogeneous dice, highlight is still set die by die.
+                    DiceHistogram* histogram = previousDiceResult->getHistogram();
+                    DiceHistogram evaluated;
+                    if(nullptr!=histogram)
+                    {
+                        evaluated = *histogram;
+                        evaluated.evaluate(m_validator,true,true);
+                    }
                     for(Die* dice : diceList)
                     {
-                        if(m_validator->hasValid(dice,true,true))
-                       {
-                            nextNode = (nullptr==m_true) ? nullptr: m_true->getCopy();
+                        if(isBudgetExhausted())
+                        {
+                            return nullptr;
+                        }
+                        bool valid;
+                        if(nullptr!=histogram)
+                        {
+                            evaluated.applyHighlight(dice);
+                            valid = (evaluated.getValidity(dice->getValue())!=0);
                         }
                         else
                         {
-                            nextNode = (nullptr==m_false) ? nullptr: m_false->getCopy();
+                            valid = m_validator->hasValid(dice,true,true);
                         }
 
+                        nextNode = valid ? m_true : m_false;
+
                         if(nullptr!=nextNode)
                         {
-                            if(nullptr==previousLoop->getNextNode())
-                            {
-                                previousLoop->setNextNode(nextNode);
-                            }
-                            if(nullptr==m_nextNode)
-                            {
-                                m_nextNode = nextNode;
-                            }
+                            // the branch of the next die, and the nodes after this one, read the frame of this die.
                             nextNode->run(previousLoop);
-                            previousLoop = getLeafNode(nextNode);
+                            m_result = keepFrame(nextNode);
+                            previousLoop = this;
                         }
                     }
                 }
                 else if((m_conditionType == OneOfThem)||(m_conditionType == AllOfThem))
                 {
-                    bool trueForAll=true;
-                    bool falseForAll=true;
-
                     bool oneIsTrue=false;
                     bool oneIsFalse=false;
 
-                    for(Die* dice : diceList)
+                    DiceHistogram* histogram = previousDiceResult->getHistogram();
+                    if(nullptr!=histogram)
                     {
-                        bool result = m_validator->hasValid(dice,true,true);
-                        trueForAll = trueForAll ? result : false;
-                        falseForAll = falseForAll ? result : false;
-
-                        oneIsTrue = (oneIsTrue==false) ? result : true;
-                        oneIsFalse = (oneIsFalse==false) ? result : true;
+                        // any/all are answered on faces and stop at the first match.
+                        DiceHistogram evaluated(*histogram);
+                        evaluated.evaluate(m_validator,true,true);
+                        oneIsTrue = evaluated.hasValidDie();
+                        oneIsFalse = evaluated.hasInvalidDie();
+                        previousDiceResult->setPendingHighlight(m_validator,&evaluated);
                     }
-                    if(m_conditionType==OneOfThem)
+                    else
                     {
-                        if(oneIsTrue)
+                        // one-of is known at the first valid die, all-of at the first invalid one. Dice are checked
+                        // on a probe, their highlight is left to setPendingHighlight.
+                        for(Die* dice : diceList)
                         {
-                            nextNode = (nullptr==m_true) ? nullptr: m_true->getCopy();
+                            if((m_conditionType==OneOfThem) ? oneIsTrue : oneIsFalse)
+                            {
+                                break;
+                            }
+                            Die probe(*dice);
+                            bool result = m_validator->hasValid(&probe,true,true);
+                            oneIsTrue = oneIsTrue || result;
+                            oneIsFalse = oneIsFalse || !result;
                         }
-                        else if(oneIsFalse)
+                        previousDiceResult->setPendingHighlight(m_validator);
+                    }
+                    // the true instruction runs when one die (one-of) or every die (all-of) fits, nothing runs otherwise.
+                    if(m_conditionType==OneOfThem)
+                    {
+                        if(oneIsTrue)
                         {
-                             nextNode = (nullptr==m_false) ? nullptr: m_false->getCopy();
+                            nextNode = m_true;
                         }
                     }
                     else if(m_conditionType==AllOfThem)
                     {
-                        if(trueForAll)
-                        {
-                            nextNode = (nullptr==m_true) ? nullptr: m_true->getCopy();
-                        }
-                        else if(falseForAll)
+                        if(!oneIsFalse)
                         {
-                             nextNode = (nullptr==m_false) ? nullptr: m_false->getCopy();
+                            nextNode = m_true;
                         }
                     }
-
-
+                    if((nullptr!=nextNode)||runNext)
+                    {
+                        // nodes which run after this one read the dice as they are.
+                        previousDiceResult->applyPendingHighlight();
+                    }
                     if(nullptr!=nextNode)
                     {
-                        if(nullptr==m_nextNode)
-                        {
-                            m_nextNode = nextNode;
-                        }
+                        // the branch runs once on its own nodes, it is not linked to this node.
                         nextNode->run(previousLoop);
                         previousLoop = getLeafNode(nextNode);
+                        m_result = previousLoop->getResult();
                     }
                 }
             }
@@ -163,10 +186,8 @@ void IfNode::run(ExecutionNode *previous)
         }
     }
 
-    if((nullptr!=m_nextNode)&&(runNext))
-    {
-        m_nextNode->run(previousLoop);
-    }
+    // a branch set as next node has already run.
+    return runNext ? previousLoop : nullptr;
 }
 
 void IfNode::setValidator(Validator* val)
@@ -263,6 +284,70 @@ ExecutionNode* IfNode::getLeafNode(ExecutionNode* node)
     return next;
 }
 
+Result* IfNode::keepFrame(ExecutionNode* branch)
+{
+    Result* leaf = getLeafNode(branch)->getResult();
+    const int first = m_frames.size();
+    QVarLengthArray<QPair<Result*,Result*>,8> moved;
+    takeResults(branch,moved);
+
+    // the frame results are linked to each other, as the node results were.
+    for(int i = first; i < m_frames.size(); ++i)
+    {
+        Result* previous = m_frames[i]->getPrevious();
+        for(const QPair<Result*,Result*>& pair : moved)
+        {
+            if(pair.first == previous)
+            {
+                m_frames[i]->setPrevious(pair.second);
+                break;
+            }
+        }
+    }
+    for(const QPair<Result*,Result*>& pair : moved)
+    {
+        if(pair.first == leaf)
+        {
+            return pair.second;
+        }
+    }
+    return leaf;
+}
+void IfNode::takeResults(ExecutionNode* branch,QVarLengthArray<QPair<Result*,Result*>,8>& moved)
+{
+    for(ExecutionNode* node = branch; nullptr!=node; node = node->getNextNode())
+    {
+        IfNode* ifNode = dynamic_cast<IfNode*>(node);
+        if(nullptr!=ifNode)
+        {
+            // the result of an if node is borrowed: its frames and the results of its branches are taken.
+            m_frames << ifNode->m_frames;
+            ifNode->m_frames.clear();
+            if(nullptr!=ifNode->m_true)
+            {
+                takeResults(ifNode->m_true,moved);
+            }
+            if(nullptr!=ifNode->m_false)
+            {
+                takeResults(ifNode->m_false,moved);
+            }
+            continue;
+        }
+        Result* result = node->getResult();
+        bool taken = (nullptr==result);
+        for(const QPair<Result*,Result*>& pair : moved)
+        {
+            taken = taken || (pair.first == result);
+        }
+        if(!taken)
+        {
+            Result* frame = result->takeContent();
+            moved.append(qMakePair(result,frame));
+            m_frames.append(frame);
+        }
+    }
+}
+
 IfNode::ConditionType IfNode::getConditionType() const
 {
     return m_conditionType;
@@ -291,6 +376,7 @@ ExecutionNode* IfNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 
 }
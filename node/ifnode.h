@@ -24,6 +24,8 @@
 #include "result/diceresult.h"
 #include "validator.h"
 #include <QDebug>
+#include <QPair>
+#include <QVarLengthArray>
 
 /**
  * @brief The ifNode class explose dice while is valid by the validator.
@@ -44,10 +46,10 @@ public:
      */
     virtual ~IfNode();
     /**
-     * @brief run
+     * @brief execute
      * @param previous
      */
-    virtual void run(ExecutionNode* previous = nullptr);
+    virtual ExecutionNode* execute(ExecutionNode* previous);
     /**
      * @brief setValidator
      */
@@ -96,6 +98,18 @@ public:
 
 protected:
     ExecutionNode *getLeafNode(ExecutionNode *node);
+    /**
+     * @brief keepFrame moves the results of a branch which has run for one die (OnEach) to the frame of this die.
+     * The frame holds results only, the branch nodes are shared by every die and left empty for the next one.
+     * @param branch m_true or m_false
+     * @return the frame result of the branch leaf.
+     */
+    Result* keepFrame(ExecutionNode* branch);
+    /**
+     * @brief takeResults moves the results of the branch nodes to m_frames, an if node of the branch gives its own frames.
+     * @param moved pairs of a node result and the frame result which took its content.
+     */
+    void takeResults(ExecutionNode* branch,QVarLengthArray<QPair<Result*,Result*>,8>& moved);
 
 protected:
     Validator* m_validator;
@@ -103,5 +117,7 @@ protected:
 
     ExecutionNode* m_true;
     ExecutionNode* m_false;
+
+    QList<Result*> m_frames;
 };
 #endif
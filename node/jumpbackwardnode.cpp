@@ -25,6 +25,7 @@ JumpBackwardNode::JumpBackwardNode()
 {
     m_previousNode=nullptr;
     m_backwardNode = nullptr;
+    m_copiedResult = nullptr;
     m_diceResult =new DiceResult();
     m_result = m_diceResult;
 }
@@ -86,7 +87,7 @@ void JumpBackwardNode::generateDotTree(QString& s)
 
 }
 
-void JumpBackwardNode::run(ExecutionNode* previous)
+ExecutionNode* JumpBackwardNode::execute(ExecutionNode* previous)
 {
         m_previousNode = previous;
 		ExecutionNode* parent = previous;
@@ -121,43 +122,44 @@ void JumpBackwardNode::run(ExecutionNode* previous)
             }
 
 		}
+        m_copiedResult = nullptr;
         if(nullptr==result)
         {
-            m_errors.insert(DIE_RESULT_EXPECTED,QObject::tr(" The @ operator expects dice result. Please check the documentation to fix your command."));
+            addError(DIE_RESULT_EXPECTED,QObject::tr(" The @ operator expects dice result. Please check the documentation to fix your command."));
+            return nullptr;
         }
-        else
+        DiceResult* diceResult = dynamic_cast<DiceResult*>(result);
+        m_diceResult->clear();
+        if(nullptr!=diceResult)
         {
-            DiceResult* diceResult = dynamic_cast<DiceResult*>(result);
-            if(nullptr!=diceResult)
+            for(Die* die : diceResult->getResultList())
             {
-                for(Die* die : diceResult->getResultList())
-                {
-                    Die* tmpdie = new Die();
-                    *tmpdie=*die;
-                    m_diceResult->insertResult(tmpdie);
-                    die->displayed();
-                }
+                Die* tmpdie = new Die();
+                *tmpdie=*die;
+                m_diceResult->insertResult(tmpdie);
+                die->displayed();
             }
+        }
+        m_copiedResult = diceResult;
 
-            m_result->setPrevious(previous->getResult());
-
-            if(nullptr!=m_nextNode)
-            {
-                m_nextNode->run(this);
-            }
-            if(nullptr!=diceResult)
+        m_result->setPrevious(previous->getResult());
+        return this;
+}
+void JumpBackwardNode::endChain()
+{
+    // the highlight set on the original dice by the next nodes is shown on the copies.
+    if(nullptr!=m_copiedResult)
+    {
+        for(int i =0;i<m_copiedResult->getResultList().size();++i)
+        {
+            Die* tmp =m_copiedResult->getResultList().at(i);
+            Die* tmp2 =m_diceResult->getResultList().at(i);
+            if(tmp->isHighlighted())
             {
-                for(int i =0;i<diceResult->getResultList().size();++i)
-                {
-                    Die* tmp =diceResult->getResultList().at(i);
-                    Die* tmp2 =m_diceResult->getResultList().at(i);
-                    if(tmp->isHighlighted())
-                    {
-                        tmp2->setHighlighted(true);
-                    }
-                }
+                tmp2->setHighlighted(true);
             }
         }
+    }
 }
 
 ExecutionNode* JumpBackwardNode::getCopy() const
@@ -167,6 +169,7 @@ ExecutionNode* JumpBackwardNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 
 }
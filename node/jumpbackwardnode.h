@@ -34,10 +34,14 @@ public:
      */
 	JumpBackwardNode();
     /**
-     * @brief run - performs the actions
+     * @brief execute - copies the dice of the closest dice result before this node.
      * @param previous
      */
-	virtual void run(ExecutionNode* previous = nullptr);
+	virtual ExecutionNode* execute(ExecutionNode* previous);
+    /**
+     * @brief endChain copies back the highlight the next nodes set on the original dice.
+     */
+    virtual void endChain();
 
 	/**
 	 * @brief toString
@@ -62,6 +66,7 @@ public:
 private:
     DiceResult* m_diceResult;
     ExecutionNode* m_backwardNode;
+    DiceResult* m_copiedResult;
 
 };
 
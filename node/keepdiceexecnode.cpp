@@ -22,6 +22,7 @@
 
 
 #include "keepdiceexecnode.h"
+#include "sortresult.h"
 
 
 KeepDiceExecNode::KeepDiceExecNode()
@@ -33,53 +34,58 @@ KeepDiceExecNode::~KeepDiceExecNode()
 {
 
 }
-void KeepDiceExecNode::run(ExecutionNode* previous)
+ExecutionNode* KeepDiceExecNode::execute(ExecutionNode* previous)
 {
     m_previousNode = previous;
     if(NULL==previous)
     {
-        return;
+        return nullptr;
     }
     DiceResult* previousDiceResult = static_cast<DiceResult*>(previous->getResult());
     m_result->setPrevious(previousDiceResult);
     if(NULL!=previousDiceResult)
     {
-        QList<Die*> diceList=previousDiceResult->getResultList();
-
-        QList<Die*> diceList3= diceList.mid(0,m_numberOfDice);
-        QList<Die*> diceList2;
-
-        foreach(Die* die,diceList3)
-        {
-            Die* tmpdie = new Die();
-            *tmpdie=*die;
-            diceList2.append(tmpdie);
-            die->displayed();
-        }
-
+        const QList<Die*>& diceList=previousDiceResult->getDiceList();
 
+        // the previous result is sorted: the kept dice are its first ones, referenced without copy.
+        QList<Die*> diceList2 = diceList.mid(0,m_numberOfDice);
 
         if(m_numberOfDice > diceList.size())
         {
-            m_errors.insert(TOO_MANY_DICE,QObject::tr(" You ask to keep %1 dice but the result only has %2").arg(m_numberOfDice).arg(diceList.size()));
+            addError(TOO_MANY_DICE,QObject::tr(" You ask to keep %1 dice but the result only has %2").arg(m_numberOfDice).arg(diceList.size()));
         }
 
-        for(Die* tmp : diceList.mid(m_numberOfDice,-1))
+        for(int i = diceList2.size(); i < diceList.size(); ++i)
         {
-            tmp->setHighlighted(false);
+            diceList[i]->setHighlighted(false);
         }
 
-        m_diceResult->setResultList(diceList2);
-        if(NULL!=m_nextNode)
+        m_diceResult->setBorrowedResultList(diceList2);
+        DiceHistogram* histogram = previousDiceResult->getHistogram();
+        if((nullptr!=histogram)&&(nullptr!=dynamic_cast<SortResultNode*>(previous))&&(!diceList.isEmpty()))
         {
-            m_nextNode->run(this);
+            // the kept dice are the lowest or the highest ones, depending on the sort order.
+            if(diceList.first()->getValue() <= diceList.last()->getValue())
+            {
+                m_diceResult->setHistogram(histogram->getLowest(m_numberOfDice));
+            }
+            else
+            {
+                m_diceResult->setHistogram(histogram->getHighest(m_numberOfDice));
+            }
         }
+        return this;
     }
+    return nullptr;
 }
 void KeepDiceExecNode::setDiceKeepNumber(quint64 n)
 {
     m_numberOfDice = n;
 }
+quint64 KeepDiceExecNode::getDiceKeepNumber() const
+{
+    return m_numberOfDice;
+}
 QString KeepDiceExecNode::toString(bool wl) const
 {
 	if(wl)
@@ -111,6 +117,7 @@ ExecutionNode* KeepDiceExecNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 
 }
@@ -33,8 +33,9 @@ public:
     KeepDiceExecNode();
     virtual ~KeepDiceExecNode();
 
-    virtual void run(ExecutionNode *previous);
+    virtual ExecutionNode* execute(ExecutionNode* previous);
     virtual void setDiceKeepNumber(quint64 );
+    quint64 getDiceKeepNumber() const;
 	virtual QString toString(bool)const;
     virtual qint64 getPriority() const;
     virtual ExecutionNode *getCopy() const;
@@ -25,7 +25,7 @@ ListAliasNode::ListAliasNode(QList<DiceAlias*>* apAlias)
 {
 	m_result = new StringResult();
 }
-void ListAliasNode::run(ExecutionNode* previous )
+ExecutionNode* ListAliasNode::execute(ExecutionNode* previous )
 {
 	m_previousNode = previous;
 	StringResult* txtResult = dynamic_cast<StringResult*>(m_result);
@@ -45,10 +45,7 @@ void ListAliasNode::run(ExecutionNode* previous )
 		m_result->setPrevious(previous->getResult());
 	}
 
-	if(nullptr!=m_nextNode)
-	{
-		m_nextNode->run(this);
-	}
+	return this;
 }
 QString ListAliasNode::buildList() const
 {
@@ -88,6 +85,7 @@ ExecutionNode* ListAliasNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 
 }
@@ -33,10 +33,10 @@ class ListAliasNode : public ExecutionNode
 public:
     ListAliasNode(QList<DiceAlias*>* mapAlias);
 	/**
-	  * @brief run
+	  * @brief execute
 	  * @param previous
 	  */
-	virtual void run(ExecutionNode* previous = nullptr);
+	virtual ExecutionNode* execute(ExecutionNode* previous);
 
 	/**
 	 * @brief toString
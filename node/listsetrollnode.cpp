@@ -20,6 +20,7 @@
  *************************************************************************/
 #include "listsetrollnode.h"
 #include "die.h"
+#include "evaluationbudget.h"
 
 ListSetRollNode::ListSetRollNode()
     :m_diceResult(new DiceResult()),m_stringResult(new StringResult()),m_unique(false)
@@ -56,7 +57,7 @@ qint64 ListSetRollNode::getPriority() const
     qint64 priority=4;
     return priority;
 }
-void ListSetRollNode::run(ExecutionNode* previous)
+ExecutionNode* ListSetRollNode::execute(ExecutionNode* previous)
 {
     m_previousNode = previous;
     if(nullptr!=previous)
@@ -64,11 +65,28 @@ void ListSetRollNode::run(ExecutionNode* previous)
         Result* result=previous->getResult();
         if(nullptr!=result)
         {
-            quint64 diceCount = result->getResult(Result::SCALAR).toReal();
+            const qreal count = result->scalar();
             m_result->setPrevious(result);
+            if(count < 0)
+            {
+                addError(NO_DICE_TO_ROLL,QObject::tr("Can't roll a negative number of dice: %1").arg(count));
+                return nullptr;
+            }
+            const quint64 diceCount = static_cast<quint64>(count);
+            m_diceResult->clear();
             QStringList rollResult;
+            EvaluationBudget* budget = EvaluationBudget::current();
+            if((nullptr!=budget)&&(!budget->allocateDice(static_cast<qint64>(diceCount))))
+            {
+                addError(BUDGET_EXCEEDED,budget->getErrorMessage());
+                return nullptr;
+            }
             for(quint64 i=0; i < diceCount ; ++i)
             {
+                if(isBudgetExhausted())
+                {
+                    return nullptr;
+                }
                 Die* die = new Die();
                 computeFacesNumber(die);
                 die->roll();
@@ -76,12 +94,10 @@ void ListSetRollNode::run(ExecutionNode* previous)
                 getValueFromDie(die,rollResult);
             }
             m_stringResult->setText(rollResult.join(","));
-            if(nullptr!=m_nextNode)
-            {
-                m_nextNode->run(this);
-            }
+            return this;
         }
     }
+    return nullptr;
 }
 void ListSetRollNode::setListValue(QStringList lirs)
 {
@@ -154,6 +170,7 @@ ExecutionNode* ListSetRollNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 
 }
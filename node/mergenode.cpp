@@ -26,7 +26,7 @@ MergeNode::MergeNode()
 {
     m_result = m_diceResult;
 }
-void MergeNode::run(ExecutionNode* previous)
+ExecutionNode* MergeNode::execute(ExecutionNode* previous)
 {
     m_previousNode = previous;
     m_result->setPrevious(previous->getResult());
@@ -51,7 +51,8 @@ void MergeNode::run(ExecutionNode* previous)
                 {
                     ///@todo improve here to set homogeneous while is really
                     m_diceResult->setHomogeneous(false);
-                    for(Die* die : dice->getResultList())
+                    dice->applyPendingHighlight();
+                    for(Die* die : dice->getDiceList())
                     {
                         if(!m_diceResult->getResultList().contains(die)&&(!die->hasBeenDisplayed()))
                         {
@@ -71,10 +72,7 @@ void MergeNode::run(ExecutionNode* previous)
     m_startList->clear();
     m_startList->append(first);
 
-    if(nullptr!=m_nextNode)
-    {
-        m_nextNode->run(this);
-    }
+    return this;
 }
 ExecutionNode* MergeNode::getLatestNode(ExecutionNode* node)
 {
@@ -112,6 +110,7 @@ ExecutionNode* MergeNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 
 }
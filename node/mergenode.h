@@ -32,7 +32,7 @@ class MergeNode : public ExecutionNode
 {
 public:
     MergeNode();
-    void run(ExecutionNode* previous);
+    ExecutionNode* execute(ExecutionNode* previous);
     virtual QString toString(bool withLabel)const;
     virtual qint64 getPriority() const;
     virtual ExecutionNode *getCopy() const;
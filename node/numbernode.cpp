@@ -36,17 +36,14 @@ NumberNode::~NumberNode()
     }*/
 }
 
-void NumberNode::run(ExecutionNode* previous)
+ExecutionNode* NumberNode::execute(ExecutionNode* previous)
 {
 	m_previousNode = previous;
     if(nullptr!=previous)
     {
         m_result->setPrevious(previous->getResult());
     }
-    if(nullptr!=m_nextNode)
-    {
-        m_nextNode->run(this);
-    }
+    return this;
 }
 
 void NumberNode::setNumber(qint64 a)
@@ -54,6 +51,10 @@ void NumberNode::setNumber(qint64 a)
     m_scalarResult->setValue(a);
     m_number = a;
 }
+qint64 NumberNode::getNumber() const
+{
+    return m_number;
+}
 QString NumberNode::toString(bool withLabel) const
 {
     if(withLabel)
@@ -84,6 +85,7 @@ ExecutionNode* NumberNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 
 }
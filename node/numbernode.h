@@ -33,8 +33,9 @@ class NumberNode : public ExecutionNode
 public:
     NumberNode();
     virtual ~NumberNode();
-    void run(ExecutionNode* previous);
+    ExecutionNode* execute(ExecutionNode* previous);
     void setNumber(qint64);
+    qint64 getNumber() const;
     virtual QString toString(bool withLabel)const;
     virtual qint64 getPriority() const;
     virtual ExecutionNode *getCopy() const;
@@ -64,19 +64,19 @@ PainterNode::~PainterNode()
 }
 
 
-void PainterNode::run(ExecutionNode* previous)
+ExecutionNode* PainterNode::execute(ExecutionNode* previous)
 {
     m_previousNode = previous;
     if(nullptr==previous)
     {
-        return;
+        return nullptr;
     }
     Result* previousResult = previous->getResult();
     //m_result = previousResult;
     DiceResult* previousDiceResult = dynamic_cast<DiceResult*>(previousResult);
     if(nullptr!=previousDiceResult)
     {
-        QList<Die*> diceList=previousDiceResult->getResultList();
+        QList<Die*> diceList=previousDiceResult->getDiceList();
         int pastDice=0;
         for(ColorItem item: m_colors)
         {
@@ -90,10 +90,8 @@ void PainterNode::run(ExecutionNode* previous)
             }
         }
     }
-    if(nullptr!=m_nextNode)
-    {
-        m_nextNode->run(previous);
-    }
+    // the painter is transparent: the next node works on the result before it.
+    return previous;
 }
 Result* PainterNode::getResult()
 {
@@ -124,6 +122,17 @@ void PainterNode::insertColorItem(QString color, int value)
     ColorItem item(color,value);
     m_colors.append(item);
 }
+bool PainterNode::hasColor() const
+{
+    for(const ColorItem& item : m_colors)
+    {
+        if(item.colorNumber()>0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
 ExecutionNode* PainterNode::getCopy() const
 {
     PainterNode* node = new PainterNode();
@@ -131,5 +140,6 @@ ExecutionNode* PainterNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 }
@@ -48,11 +48,16 @@ class PainterNode : public ExecutionNode
 public:
     PainterNode();
     virtual ~PainterNode();
-    virtual void run(ExecutionNode* previous = nullptr);
+    virtual ExecutionNode* execute(ExecutionNode* previous);
     Result* getResult();
     virtual QString toString(bool )const;
     virtual qint64 getPriority() const;
     void insertColorItem(QString color, int value);
+    /**
+     * @brief hasColor
+     * @return false when no die can be painted, the node does nothing then.
+     */
+    bool hasColor() const;
     virtual ExecutionNode *getCopy() const;
 protected:
     QList<ColorItem> m_colors;
@@ -30,7 +30,11 @@ void ParenthesesNode::setInternelNode(ExecutionNode* node)
 {
     m_internalNode = node;
 }
-void ParenthesesNode::run(ExecutionNode* /*previous*/)
+ExecutionNode* ParenthesesNode::getInternalNode() const
+{
+    return m_internalNode;
+}
+ExecutionNode* ParenthesesNode::execute(ExecutionNode* /*previous*/)
 {
 	m_previousNode = nullptr;
     if(nullptr!=m_internalNode)
@@ -43,12 +47,7 @@ void ParenthesesNode::run(ExecutionNode* /*previous*/)
        }
        m_result = temp->getResult();
     }
-
-
-    if(nullptr!=m_nextNode)
-    {
-        m_nextNode->run(this);
-    }
+    return this;
 }
 QString ParenthesesNode::toString(bool b) const
 {
@@ -77,6 +76,7 @@ ExecutionNode* ParenthesesNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 
 }
@@ -31,9 +31,10 @@ class ParenthesesNode : public ExecutionNode
 {
 public:
     ParenthesesNode();
-    virtual void run(ExecutionNode* previous = nullptr);
+    virtual ExecutionNode* execute(ExecutionNode* previous);
 
     void setInternelNode(ExecutionNode* node);
+    ExecutionNode* getInternalNode() const;
 	virtual QString toString(bool)const;
     virtual qint64 getPriority() const;
     virtual ExecutionNode *getCopy() const;
@@ -14,7 +14,7 @@ RerollDiceNode::~RerollDiceNode()
 		m_validator = nullptr;
 	}
 }
-void RerollDiceNode::run(ExecutionNode* previous)
+ExecutionNode* RerollDiceNode::execute(ExecutionNode* previous)
 {
     m_previousNode = previous;
     if((nullptr!=previous)&&(nullptr!=previous->getResult()))
@@ -23,7 +23,8 @@ void RerollDiceNode::run(ExecutionNode* previous)
         m_result->setPrevious(previous_result);
         if(nullptr!=previous_result)
         {
-            for(Die* die : previous_result->getResultList())
+            m_diceResult->clear();
+            for(Die* die : previous_result->getDiceList())
             {
                 Die* tmpdie = new Die();
                 *tmpdie=*die;
@@ -36,23 +37,30 @@ void RerollDiceNode::run(ExecutionNode* previous)
 
             for(Die* die: list)
             {
+                if(isBudgetExhausted())
+                {
+                    return nullptr;
+                }
                 if(m_validator->hasValid(die,false))
                 {
                     die->roll(m_adding);
                 }
             }
+            m_diceResult->invalidateHistogram();
 
-            if(nullptr!=m_nextNode)
-            {
-                m_nextNode->run(this);
-            }
+            return this;
         }
     }
+    return nullptr;
 }
 void RerollDiceNode::setValidator(Validator* val)
 {
       m_validator = val;
 }
+const Validator* RerollDiceNode::getValidator() const
+{
+    return m_validator;
+}
 QString RerollDiceNode::toString(bool wl) const
 {
 	if(wl)
@@ -69,6 +77,10 @@ void RerollDiceNode::setAddingMode(bool b)
 {
     m_adding = b;
 }
+bool RerollDiceNode::isAddingMode() const
+{
+    return m_adding;
+}
 qint64 RerollDiceNode::getPriority() const
 {
     qint64 priority=0;
@@ -89,5 +101,6 @@ ExecutionNode* RerollDiceNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 }
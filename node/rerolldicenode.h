@@ -26,15 +26,20 @@ public:
 	 */
 	virtual ~RerollDiceNode();
 	/**
-	 * @brief run
+	 * @brief execute
 	 * @param previous
 	 */
-    virtual void run(ExecutionNode* previous);
+    virtual ExecutionNode* execute(ExecutionNode* previous);
 
 	/**
 	 * @brief setValidator
 	 */
     virtual void setValidator(Validator* );
+	/**
+	 * @brief getValidator
+	 * @return the validator, still owned by this node.
+	 */
+    const Validator* getValidator() const;
 	/**
 	 * @brief toString
 	 * @return
@@ -46,6 +51,11 @@ public:
 	 * @brief setAddingMode
 	 */
     virtual void setAddingMode(bool);
+	/**
+	 * @brief isAddingMode
+	 * @return true when new values are added to the die instead of replacing the last one.
+	 */
+    bool isAddingMode() const;
 	/**
 	 * @brief getPriority
 	 * @return
@@ -45,7 +45,7 @@ ScalarOperatorNode::~ScalarOperatorNode()
     }
 }
 
-void ScalarOperatorNode::run(ExecutionNode* previous)
+ExecutionNode* ScalarOperatorNode::execute(ExecutionNode* previous)
 {
     m_previousNode = previous;
     if(NULL!=m_internalNode)
@@ -64,22 +64,23 @@ void ScalarOperatorNode::run(ExecutionNode* previous)
                 while(nullptr != internal->getNextNode() )
                 {
                     internal = internal->getNextNode();
-             }
+                }
+                Result* internalResult = internal->getResult();
 
 
                 switch(m_arithmeticOperator)
                 {
                 case Die::PLUS:
-                    m_scalarResult->setValue(add(previousResult->getResult(Result::SCALAR).toReal(),internalResult->getResult(Result::SCALAR).toReal()));
+                    m_scalarResult->setValue(add(previousResult->scalar(),internalResult->scalar()));
                     break;
                 case Die::MINUS:
-                    m_scalarResult->setValue(substract(previousResult->getResult(Result::SCALAR).toReal(),internalResult->getResult(Result::SCALAR).toReal()));
+                    m_scalarResult->setValue(substract(previousResult->scalar(),internalResult->scalar()));
                     break;
                 case Die::MULTIPLICATION:
-                    m_scalarResult->setValue(multiple(previousResult->getResult(Result::SCALAR).toReal(),internalResult->getResult(Result::SCALAR).toReal()));
+                    m_scalarResult->setValue(multiple(previousResult->scalar(),internalResult->scalar()));
                     break;
                 case Die::DIVIDE:
-                    m_scalarResult->setValue(divide(previousResult->getResult(Result::SCALAR).toReal(),internalResult->getResult(Result::SCALAR).toReal()));
+                    m_scalarResult->setValue(divide(previousResult->scalar(),internalResult->scalar()));
                     break;
                 default:
                     break;
@@ -87,12 +88,10 @@ void ScalarOperatorNode::run(ExecutionNode* previous)
             }
             }
 
-            if(NULL!=m_nextNode)
-            {
-                m_nextNode->run(this);
-            }
+            return this;
         }
     }
+    return nullptr;
 
 }
 /*bool ScalarOperatorNode::setOperatorChar(QChar c)
@@ -109,6 +108,10 @@ void ScalarOperatorNode::setInternalNode(ExecutionNode* node)
 {
     m_internalNode = node;
 }
+ExecutionNode* ScalarOperatorNode::getInternalNode() const
+{
+    return m_internalNode;
+}
 qint64 ScalarOperatorNode::add(qint64 a,qint64 b)
 {
     return a+b;
@@ -121,7 +124,7 @@ qreal ScalarOperatorNode::divide(qint64 a,qint64 b)
 {
     if(b==0)
     {
-        m_errors.insert(DIVIDE_BY_ZERO,QObject::tr("Division by zero"));
+        addError(DIVIDE_BY_ZERO,QObject::tr("Division by zero"));
         return 0;
     }
     return (qreal)a/b;
@@ -215,21 +218,24 @@ void ScalarOperatorNode::generateDotTree(QString& s)
 }
 QMap<ExecutionNode::DICE_ERROR_CODE,QString> ScalarOperatorNode::getExecutionErrorMap()
 {
+    QMap<ExecutionNode::DICE_ERROR_CODE,QString> errors = m_errors;
     if(NULL!=m_internalNode)
     {
-        for (ExecutionNode::DICE_ERROR_CODE key: m_internalNode->getExecutionErrorMap().keys())
+        const auto internalErrors = m_internalNode->getExecutionErrorMap();
+        for(auto it = internalErrors.constBegin(); it != internalErrors.constEnd(); ++it)
         {
-            m_errors.insert(key,m_internalNode->getExecutionErrorMap().value(key));
+            errors.insert(it.key(),it.value());
         }
     }
     if(NULL!=m_nextNode)
     {
-        for (ExecutionNode::DICE_ERROR_CODE key: m_nextNode->getExecutionErrorMap().keys())
+        const auto nextErrors = m_nextNode->getExecutionErrorMap();
+        for(auto it = nextErrors.constBegin(); it != nextErrors.constEnd(); ++it)
         {
-            m_errors.insert(key,m_nextNode->getExecutionErrorMap().value(key));
+            errors.insert(it.key(),it.value());
         }
     }
-    return m_errors;
+    return errors;
 }
 ExecutionNode* ScalarOperatorNode::getCopy() const
 {
@@ -240,5 +246,6 @@ ExecutionNode* ScalarOperatorNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 }
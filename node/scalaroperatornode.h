@@ -49,14 +49,19 @@ public:
      */
     virtual ~ScalarOperatorNode();
     /**
-     * @brief run
+     * @brief execute
      */
-    virtual void run(ExecutionNode*);
+    virtual ExecutionNode* execute(ExecutionNode* previous);
     /**
      * @brief setInternalNode
      * @param node
      */
     void setInternalNode(ExecutionNode* node);
+    /**
+     * @brief getInternalNode
+     * @return first node of the right operand.
+     */
+    ExecutionNode* getInternalNode() const;
     /**
      * @brief toString
      * @param wl
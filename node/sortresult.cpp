@@ -24,6 +24,11 @@
 #include <QDebug>
 #include "die.h"
 
+#include <algorithm>
+#include <vector>
+
+#define MAX_COUNTING_RANGE 1024
+
 SortResultNode::SortResultNode()
     : m_diceResult(new DiceResult)
 {
@@ -31,83 +36,106 @@ SortResultNode::SortResultNode()
     m_result = m_diceResult;
 
 }
-void SortResultNode::run(ExecutionNode* node)
+ExecutionNode* SortResultNode::execute(ExecutionNode* node)
 {
 	m_previousNode = node;
     if(nullptr==node)
     {
-        return;
+        return nullptr;
     }
     DiceResult* previousDiceResult = dynamic_cast<DiceResult*>(node->getResult());
     m_diceResult->setPrevious(previousDiceResult);
     if(nullptr!=previousDiceResult)
     {   
-        QList<Die*> diceList=previousDiceResult->getResultList();
-        QList<Die*> diceList2=m_diceResult->getResultList();
-
-        // half-interval search sorting
-        for(int i = 0; i<diceList.size();++i)
+        QList<Die*> diceList2 = sortDice(previousDiceResult->getDiceList(),m_ascending);
+        m_diceResult->setBorrowedResultList(diceList2);
+        DiceHistogram* histogram = previousDiceResult->getHistogram();
+        if(nullptr!=histogram)
         {
-
-            Die* tmp1 = new Die();
-            *tmp1=*diceList[i];
-            diceList[i]->displayed();
-
-            int j =0;
-            bool found = false;
-            int start = 0;
-            int end = diceList2.size();
-            Die* tmp2 = NULL;
-            while(!found)
-            {
-                int distance = end-start;
-                j = (start+end)/2;
-                if(distance == 0)
-                {
-                    j=end;
-                    found=true;
-                }
-                else
-                {
-                    tmp2 = diceList2[j];
-                    if(tmp1->getValue() < tmp2->getValue())
-                    {
-                            end=j;
-                    }
-                    else
-                    {
-                            start=j+1;
-                    }
-                }
-            }
-            diceList2.insert(j,tmp1);
+            m_diceResult->setHistogram(*histogram);
         }
-
-        if(!m_ascending)
+        return this;
+    }
+    else
+    {
+        //m_result = node->getResult();
+        //m_errors.append(DIE_RESULT_EXPECTED);
+    }
+    return nullptr;
+}
+QList<Die*> SortResultNode::sortDice(const QList<Die*>& diceList, bool ascending)
+{
+    // dice values are packed once, the sort works on indexes and never moves Die objects.
+    std::vector<qint64> values;
+    values.reserve(diceList.size());
+    qint64 min = 0;
+    qint64 max = 0;
+    for(Die* die : diceList)
+    {
+        qint64 value = die->getValue();
+        if(values.empty() || value < min)
+        {
+            min = value;
+        }
+        if(values.empty() || value > max)
         {
-            for(int i = 0; i< diceList2.size()/2; ++i)
-            {
-                diceList2.swap(i,diceList2.size()-(1+i));
-            }
+            max = value;
+        }
+        values.push_back(value);
+    }
 
+    std::vector<int> order(values.size());
+    quint64 range = static_cast<quint64>(max-min)+1;
+    if(!values.empty() && (range <= static_cast<quint64>(2*values.size()+MAX_COUNTING_RANGE)))
+    {
+        // counting sort: values are bounded by the faces.
+        std::vector<int> counts(range+1,0);
+        for(qint64 value : values)
+        {
+            ++counts[value-min+1];
         }
-        m_diceResult->setResultList(diceList2);
-        if(NULL!=m_nextNode)
+        for(quint64 i = 1; i < counts.size(); ++i)
         {
-            m_nextNode->run(this);
+            counts[i] += counts[i-1];
+        }
+        for(std::size_t i = 0; i < values.size(); ++i)
+        {
+            order[counts[values[i]-min]++] = static_cast<int>(i);
         }
     }
     else
     {
-        //m_result = node->getResult();
-        //m_errors.append(DIE_RESULT_EXPECTED);
+        for(std::size_t i = 0; i < order.size(); ++i)
+        {
+            order[i] = static_cast<int>(i);
+        }
+        std::stable_sort(order.begin(),order.end(),[&values](int a, int b){
+            return values[a] < values[b];
+        });
+    }
+
+    // the descending order is the ascending one reversed, equal dice included.
+    if(!ascending)
+    {
+        std::reverse(order.begin(),order.end());
     }
 
+    QList<Die*> sorted;
+    sorted.reserve(diceList.size());
+    for(int index : order)
+    {
+        sorted.append(diceList[index]);
+    }
+    return sorted;
 }
 void SortResultNode::setSortAscending(bool asc)
 {
     m_ascending = asc;
 }
+bool SortResultNode::isAscending() const
+{
+    return m_ascending;
+}
 QString SortResultNode::toString(bool wl) const
 {
 	if(wl)
@@ -139,6 +167,7 @@ ExecutionNode* SortResultNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 
 }
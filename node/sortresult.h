@@ -26,7 +26,8 @@
 #include "result/diceresult.h"
 /**
  * @brief The SortResultNode class is an ExecutionNode, and it is dedicated to sort dice list.
- * The sort is made by hand, using half-interval search algorithm.
+ * The sort is a stable counting sort over the values (index sort when values are too spread),
+ * the result references the previous dice without copying them.
  */
 class SortResultNode : public ExecutionNode
 {
@@ -36,15 +37,20 @@ public:
      */
     SortResultNode();
     /**
-     * @brief run
+     * @brief execute
      */
-    virtual void run(ExecutionNode*);
+    virtual ExecutionNode* execute(ExecutionNode* previous);
 
     /**
      * @brief setSortAscending
      * @param asc
      */
     void setSortAscending(bool asc);
+    /**
+     * @brief isAscending
+     * @return
+     */
+    bool isAscending() const;
     /**
      * @brief toString
      * @return
@@ -60,6 +66,13 @@ public:
      * @return
      */
     virtual ExecutionNode *getCopy() const;
+    /**
+     * @brief sortDice stable sort of the dice by value.
+     * @param diceList dice to sort, they are not modified.
+     * @param ascending
+     * @return the sorted list of the same dice.
+     */
+    static QList<Die*> sortDice(const QList<Die*>& diceList, bool ascending);
 private:
     bool m_ascending;
     DiceResult* m_diceResult;
@@ -26,7 +26,7 @@ SplitNode::SplitNode()
 {
     m_result = m_diceResult;
 }
-void SplitNode::run(ExecutionNode* previous)
+ExecutionNode* SplitNode::execute(ExecutionNode* previous)
 {
     m_previousNode = previous;
     if(nullptr!=previous)
@@ -39,7 +39,8 @@ void SplitNode::run(ExecutionNode* previous)
             DiceResult* dice = dynamic_cast<DiceResult*>(tmpResult);
             if(nullptr!=dice)
             {
-                for(Die* oldDie : dice->getResultList())
+                m_diceResult->clear();
+                for(Die* oldDie : dice->getDiceList())
                 {
                     oldDie->displayed();
                     m_diceResult->setOperator(oldDie->getOp());
@@ -56,10 +57,7 @@ void SplitNode::run(ExecutionNode* previous)
             }
         }
     }
-    if(nullptr!=m_nextNode)
-    {
-        m_nextNode->run(this);
-    }
+    return this;
 }
 
 QString SplitNode::toString(bool withLabel) const
@@ -89,6 +87,7 @@ ExecutionNode* SplitNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 
 }
@@ -32,7 +32,7 @@ class SplitNode : public ExecutionNode
 {
 public:
     SplitNode();
-    void run(ExecutionNode* previous);
+    ExecutionNode* execute(ExecutionNode* previous);
     virtual QString toString(bool withLabel)const;
     virtual qint64 getPriority() const;
     virtual ExecutionNode *getCopy() const;
@@ -24,12 +24,9 @@ StartingNode::StartingNode()
 {
 
 }
-void StartingNode::run(ExecutionNode*)
+ExecutionNode* StartingNode::execute(ExecutionNode*)
 {
-    if(nullptr!=m_nextNode)
-    {
-        m_nextNode->run(this);
-    }
+    return this;
 }
 QString StartingNode::toString(bool withlabel) const
 {
@@ -60,6 +57,7 @@ ExecutionNode* StartingNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 
 }
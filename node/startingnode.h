@@ -34,9 +34,9 @@ public:
      */
     StartingNode();
     /**
-     * @brief run
+     * @brief execute
      */
-    virtual void run(ExecutionNode*);
+    virtual ExecutionNode* execute(ExecutionNode* previous);
     /**
      * @brief toString
      * @return
@@ -6,17 +6,14 @@ StringNode::StringNode()
     m_result = m_stringResult;
 }
 
-void StringNode::run(ExecutionNode *previous)
+ExecutionNode* StringNode::execute(ExecutionNode *previous)
 {
     m_previousNode = previous;
     if(nullptr!=previous)
     {
         m_result->setPrevious(previous->getResult());
     }
-    if(nullptr!=m_nextNode)
-    {
-        m_nextNode->run(this);
-    }
+    return this;
 }
 
 void StringNode::setString(QString str)
@@ -125,6 +122,7 @@ ExecutionNode* StringNode::getCopy() const
     {
         node->setNextNode(m_nextNode->getCopy());
     }
+    node->setSourceSpan(m_sourcePosition,m_sourceLength);
     return node;
 
 }
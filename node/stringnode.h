@@ -11,7 +11,7 @@ class StringNode : public ExecutionNode
 {
 public:
     StringNode();
-    void run(ExecutionNode* previous);
+    ExecutionNode* execute(ExecutionNode* previous);
     void setString(QString str);
     virtual QString toString(bool withLabel)const;
     virtual qint64 getPriority() const;
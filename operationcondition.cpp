@@ -86,6 +86,14 @@ void OperationCondition::setValue(qint64 v)
 {
     m_value=v;
 }
+OperationCondition::ConditionOperator OperationCondition::getOperator() const
+{
+    return m_operator;
+}
+qint64 OperationCondition::getValue() const
+{
+    return m_value;
+}
 QString OperationCondition::toString()
 {
     QString str(QStringLiteral(""));
@@ -35,6 +35,8 @@ public:
 
     void setOperator(ConditionOperator m);
     void setValue(qint64);
+    ConditionOperator getOperator() const;
+    qint64 getValue() const;
     QString toString();
 
     virtual quint64 getValidRangeSize(quint64 faces) const;
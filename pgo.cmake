@@ -0,0 +1,147 @@
+# Profile-guided build of diceparser_core, run by the pgo target (cmake -DDICE_PGO=ON, then make pgo).
+#
+# 1. baseline: Release build of diceparser_bench.
+# 2. instrumented: same build with DICE_PGO_MODE=GENERATE, trained by the benchmarks on cli/cmds.txt plus the
+#    commands of DICE_PGO_TRACES (production traces, one command per line).
+# 3. optimized: the instrumented build directory built again with DICE_PGO_MODE=USE. GCC finds its .gcda files
+#    next to the objects, clang reads the merged .profdata.
+# 4. both builds run the measure benchmarks, the speedup is reported.
+#
+# Variables: SOURCE_DIR, WORK_DIR, CXX_COMPILER, COMPILER_ID, TRACES (optional), TRAIN_FILTER, MEASURE_FILTER.
+
+cmake_minimum_required(VERSION 3.0)
+
+if(NOT TRAIN_FILTER)
+    set(TRAIN_FILTER "^(parse|start|results|format/text)/")
+endif()
+if(NOT MEASURE_FILTER)
+    set(MEASURE_FILTER "^(parse|start)/")
+endif()
+
+set(BASELINE_DIR ${WORK_DIR}/baseline)
+set(PGO_DIR ${WORK_DIR}/optimized)
+set(PROFILE_DIR ${WORK_DIR}/profile)
+set(TRAINING_CMDS ${WORK_DIR}/training_cmds.txt)
+
+function(run_step description)
+    message(STATUS "pgo: ${description}")
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "pgo: ${description} failed (${result})")
+    endif()
+endfunction()
+
+function(build_bench directory)
+    file(MAKE_DIRECTORY ${directory})
+    execute_process(COMMAND ${CMAKE_COMMAND} ${SOURCE_DIR} -DCMAKE_BUILD_TYPE=Release -DCMAKE_CXX_COMPILER=${CXX_COMPILER}
+                            -DDICE_PGO=OFF ${ARGN}
+                    WORKING_DIRECTORY ${directory} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "pgo: configuration of ${directory} failed")
+    endif()
+    run_step("build ${directory}" ${CMAKE_COMMAND} --build ${directory} --target diceparser_bench)
+endfunction()
+
+# read "name",iterations,ns/op,... lines of diceparser_bench --csv into <prefix>_names and <prefix>_<index> (ns/op).
+function(read_csv file prefix)
+    file(READ ${file} content)
+    # ; and [ ] of the commands would break the list of lines.
+    string(REPLACE ";" "_" content "${content}")
+    string(REPLACE "[" "(" content "${content}")
+    string(REPLACE "]" ")" content "${content}")
+    string(REPLACE "\n" ";" lines "${content}")
+    set(names)
+    foreach(line IN LISTS lines)
+        if(line MATCHES "^\"(.*)\",[0-9]+,([0-9]+)\\.[0-9]+,")
+            string(MD5 key "${CMAKE_MATCH_1}")
+            list(APPEND names ${key})
+            set(${prefix}_${key} ${CMAKE_MATCH_2} PARENT_SCOPE)
+        endif()
+    endforeach()
+    set(${prefix}_names ${names} PARENT_SCOPE)
+endfunction()
+
+# ratio in thousandths to "1.234".
+function(format_ratio ratio output)
+    math(EXPR units "${ratio}/1000")
+    math(EXPR thousandths "${ratio}%1000+1000")
+    string(SUBSTRING ${thousandths} 1 3 thousandths)
+    set(${output} "${units}.${thousandths}" PARENT_SCOPE)
+endfunction()
+
+# the training corpus: cli/cmds.txt and the traces.
+file(READ ${SOURCE_DIR}/cli/cmds.txt corpus)
+if(TRACES)
+    file(READ ${TRACES} traces)
+    set(corpus "${corpus}\n${traces}")
+endif()
+file(WRITE ${TRAINING_CMDS} "${corpus}")
+
+# 1. baseline
+build_bench(${BASELINE_DIR} -DDICE_PGO_MODE=)
+
+# 2. instrumented build and training
+file(REMOVE_RECURSE ${PROFILE_DIR})
+file(MAKE_DIRECTORY ${PROFILE_DIR})
+file(GLOB_RECURSE stale ${PGO_DIR}/*.gcda)
+if(stale)
+    file(REMOVE ${stale})
+endif()
+build_bench(${PGO_DIR} -DDICE_PGO_MODE=GENERATE -DDICE_PGO_PROFILE=${PROFILE_DIR})
+run_step("training" ${PGO_DIR}/bench/bin/diceparser_bench --cmds ${TRAINING_CMDS} --filter ${TRAIN_FILTER} --min-time 20)
+
+set(profile "")
+if(COMPILER_ID MATCHES "Clang")
+    get_filename_component(compiler_dir ${CXX_COMPILER} DIRECTORY)
+    find_program(LLVM_PROFDATA NAMES llvm-profdata HINTS ${compiler_dir})
+    if(NOT LLVM_PROFDATA)
+        message(FATAL_ERROR "pgo: llvm-profdata is needed to merge the clang profiles")
+    endif()
+    file(GLOB raw_profiles ${PROFILE_DIR}/*.profraw)
+    set(profile ${PROFILE_DIR}/diceparser.profdata)
+    run_step("merge of the profiles" ${LLVM_PROFDATA} merge -output=${profile} ${raw_profiles})
+endif()
+
+# 3. optimized build, in the same directory: GCC matches the profiles by object path.
+build_bench(${PGO_DIR} -DDICE_PGO_MODE=USE -DDICE_PGO_PROFILE=${profile})
+
+# 4. speedup
+foreach(build baseline optimized)
+    if(build STREQUAL "baseline")
+        set(directory ${BASELINE_DIR})
+    else()
+        set(directory ${PGO_DIR})
+    endif()
+    execute_process(COMMAND ${directory}/bench/bin/diceparser_bench --filter ${MEASURE_FILTER} --min-time 200 --csv
+                    OUTPUT_FILE ${WORK_DIR}/${build}.csv RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "pgo: measure of the ${build} build failed")
+    endif()
+endforeach()
+
+read_csv(${WORK_DIR}/baseline.csv baseline)
+read_csv(${WORK_DIR}/optimized.csv optimized)
+set(count 0)
+set(ratioSum 0)
+set(baselineTotal 0)
+set(optimizedTotal 0)
+foreach(key IN LISTS baseline_names)
+    if(DEFINED optimized_${key} AND optimized_${key} GREATER 0)
+        math(EXPR count "${count}+1")
+        math(EXPR ratioSum "${ratioSum}+(${baseline_${key}}*1000)/${optimized_${key}}")
+        math(EXPR baselineTotal "${baselineTotal}+${baseline_${key}}")
+        math(EXPR optimizedTotal "${optimizedTotal}+${optimized_${key}}")
+    endif()
+endforeach()
+if(count EQUAL 0 OR optimizedTotal EQUAL 0)
+    message(FATAL_ERROR "pgo: no benchmark to compare")
+endif()
+math(EXPR meanRatio "${ratioSum}/${count}")
+math(EXPR totalRatio "(${baselineTotal}*1000)/${optimizedTotal}")
+format_ratio(${meanRatio} meanSpeedup)
+format_ratio(${totalRatio} totalSpeedup)
+message(STATUS "pgo: ${count} benchmarks, mean speedup x${meanSpeedup}, sum of ns/op ${baselineTotal} -> ${optimizedTotal} (x${totalSpeedup})")
+message(STATUS "pgo: csv in ${WORK_DIR}, optimized build in ${PGO_DIR}")
+if(profile)
+    message(STATUS "pgo: use the profile in another build with -DDICE_PGO_MODE=USE -DDICE_PGO_PROFILE=${profile}")
+endif()
@@ -83,6 +83,14 @@ bool Range::isFullyDefined() const
 {
     return (m_hasEnd && m_hasStart);
 }
+bool Range::hasStart() const
+{
+    return m_hasStart;
+}
+bool Range::hasEnd() const
+{
+    return m_hasEnd;
+}
 qint64 Range::getStart() const
 {
  return m_start;
@@ -96,7 +104,7 @@ void Range::setEmptyRange(bool b)
     m_emptyRange = b;
 }
 
-bool Range::isEmptyRange()
+bool Range::isEmptyRange() const
 {
     return m_emptyRange;
 }
@@ -41,11 +41,13 @@ public:
     virtual quint64 getValidRangeSize(quint64 faces) const;
 
     bool isFullyDefined() const;
+    bool hasStart() const;
+    bool hasEnd() const;
     qint64 getStart() const;
     qint64 getEnd() const;
 
     void setEmptyRange(bool);
-    bool isEmptyRange();
+    bool isEmptyRange() const;
 
     virtual Validator* getCopy() const;
 private:
@@ -0,0 +1,230 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include "dicehistogram.h"
+#include "validator.h"
+
+#define MAX_HISTOGRAM_RANGE 1024
+
+DiceHistogram::DiceHistogram()
+    : m_minValue(0),m_diceCount(0),m_sum(0),m_valid(false)
+{
+
+}
+bool DiceHistogram::build(const QList<Die*>& diceList)
+{
+    m_valid = false;
+    m_counts.clear();
+    m_validity.clear();
+    m_highlight.clear();
+    m_diceCount = 0;
+    m_sum = 0;
+    if(diceList.isEmpty())
+    {
+        return false;
+    }
+    qint64 min = 0;
+    qint64 max = 0;
+    bool first = true;
+    for(Die* die : diceList)
+    {
+        if((die->hasChildrenValue())||(die->getValue()!=die->getLastRolledValue()))
+        {
+            return false;
+        }
+        qint64 value = die->getValue();
+        if(first || value < min)
+        {
+            min = value;
+        }
+        if(first || value > max)
+        {
+            max = value;
+        }
+        first = false;
+    }
+    if(static_cast<quint64>(max-min) >= MAX_HISTOGRAM_RANGE)
+    {
+        return false;
+    }
+    m_minValue = min;
+    m_counts.fill(0,static_cast<int>(max-min)+1);
+    for(Die* die : diceList)
+    {
+        ++m_counts[static_cast<int>(die->getValue()-min)];
+    }
+    m_diceCount = static_cast<quint64>(diceList.size());
+    computeSum();
+    m_valid = true;
+    return true;
+}
+bool DiceHistogram::isValid() const
+{
+    return m_valid;
+}
+quint64 DiceHistogram::getDiceCount() const
+{
+    return m_diceCount;
+}
+int DiceHistogram::getIndex(qint64 value) const
+{
+    if((value < m_minValue)||(value-m_minValue >= m_counts.size()))
+    {
+        return -1;
+    }
+    return static_cast<int>(value-m_minValue);
+}
+quint64 DiceHistogram::getCount(qint64 value) const
+{
+    int i = getIndex(value);
+    return (i<0) ? 0 : m_counts[i];
+}
+qint64 DiceHistogram::getSum() const
+{
+    return m_sum;
+}
+void DiceHistogram::computeSum()
+{
+    m_sum = 0;
+    for(int i = 0; i < m_counts.size(); ++i)
+    {
+        m_sum += static_cast<qint64>(m_counts[i])*(m_minValue+i);
+    }
+}
+qint64 DiceHistogram::evaluate(const Validator* validator,bool recursive,bool unhighlight)
+{
+    m_validity.fill(0,m_counts.size());
+    m_highlight.fill(false,m_counts.size()*2);
+    if(nullptr==validator)
+    {
+        return 0;
+    }
+    // a die with a single value: the validator only depends on the value and on the previous highlight.
+    Die probe;
+    probe.insertRollValue(m_minValue);
+    qint64 sum = 0;
+    for(int i = 0; i < m_counts.size(); ++i)
+    {
+        if(m_counts[i]==0)
+        {
+            continue;
+        }
+        probe.replaceLastValue(m_minValue+i);
+        for(int previous = 0; previous < 2; ++previous)
+        {
+            probe.setHighlighted(previous==1);
+            qint64 validity = validator->hasValid(&probe,recursive,unhighlight);
+            m_validity[i] = validity;
+            m_highlight[i*2+previous] = probe.isHighlighted();
+        }
+        sum += m_validity[i]*static_cast<qint64>(m_counts[i]);
+    }
+    return sum;
+}
+qint64 DiceHistogram::getValidity(qint64 value) const
+{
+    int i = getIndex(value);
+    return ((i<0)||(i>=m_validity.size())) ? 0 : m_validity[i];
+}
+bool DiceHistogram::hasValidDie() const
+{
+    for(int i = 0; i < m_validity.size(); ++i)
+    {
+        if((m_counts[i]>0)&&(m_validity[i]!=0))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+bool DiceHistogram::hasInvalidDie() const
+{
+    for(int i = 0; i < m_validity.size(); ++i)
+    {
+        if((m_counts[i]>0)&&(m_validity[i]==0))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+void DiceHistogram::applyHighlight(const QList<Die*>& diceList) const
+{
+    for(Die* die : diceList)
+    {
+        applyHighlight(die);
+    }
+}
+void DiceHistogram::applyHighlight(Die* die) const
+{
+    int i = getIndex(die->getValue());
+    if((i>=0)&&(i*2+1<m_highlight.size()))
+    {
+        die->setHighlighted(m_highlight[i*2+(die->isHighlighted() ? 1 : 0)]);
+    }
+}
+DiceHistogram DiceHistogram::getValidPart() const
+{
+    DiceHistogram part(*this);
+    part.m_validity.clear();
+    part.m_highlight.clear();
+    part.m_diceCount = 0;
+    for(int i = 0; i < part.m_counts.size(); ++i)
+    {
+        if((i>=m_validity.size())||(m_validity[i]==0))
+        {
+            part.m_counts[i] = 0;
+        }
+        part.m_diceCount += part.m_counts[i];
+    }
+    part.computeSum();
+    return part;
+}
+DiceHistogram DiceHistogram::getLowest(quint64 number) const
+{
+    DiceHistogram part(*this);
+    part.m_validity.clear();
+    part.m_highlight.clear();
+    part.m_diceCount = 0;
+    for(int i = 0; i < part.m_counts.size(); ++i)
+    {
+        part.m_counts[i] = qMin(part.m_counts[i],number);
+        number -= part.m_counts[i];
+        part.m_diceCount += part.m_counts[i];
+    }
+    part.computeSum();
+    return part;
+}
+DiceHistogram DiceHistogram::getHighest(quint64 number) const
+{
+    DiceHistogram part(*this);
+    part.m_validity.clear();
+    part.m_highlight.clear();
+    part.m_diceCount = 0;
+    for(int i = part.m_counts.size()-1; i >= 0; --i)
+    {
+        part.m_counts[i] = qMin(part.m_counts[i],number);
+        number -= part.m_counts[i];
+        part.m_diceCount += part.m_counts[i];
+    }
+    part.computeSum();
+    return part;
+}
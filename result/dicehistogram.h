@@ -0,0 +1,134 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef DICEHISTOGRAM_H
+#define DICEHISTOGRAM_H
+
+#include <QList>
+#include <QVector>
+
+#include "die.h"
+
+class Validator;
+/**
+ * @brief The DiceHistogram class stores a pool of dice as the number of dice for each value.
+ * Counting, keeping or filtering homogeneous dice costs O(faces) instead of O(dice).
+ * Only dice with one rolled value are eligible (no explosion, no reroll in adding mode).
+ */
+class DiceHistogram
+{
+public:
+    /**
+     * @brief DiceHistogram
+     */
+    DiceHistogram();
+    /**
+     * @brief build fills the histogram from the dice list.
+     * @param diceList
+     * @return false if one die is not eligible or if the value range is too wide.
+     */
+    bool build(const QList<Die*>& diceList);
+    /**
+     * @brief isValid
+     * @return true when the histogram describes the dice.
+     */
+    bool isValid() const;
+    /**
+     * @brief getDiceCount
+     * @return number of dice
+     */
+    quint64 getDiceCount() const;
+    /**
+     * @brief getCount
+     * @param value
+     * @return number of dice showing value.
+     */
+    quint64 getCount(qint64 value) const;
+    /**
+     * @brief getSum
+     * @return sum of all dice values.
+     */
+    qint64 getSum() const;
+    /**
+     * @brief evaluate checks the validator once for each distinct value.
+     * The highlight effect is recorded for both previous highlight states, see applyHighlight.
+     * @return the validator sum over the whole pool.
+     */
+    qint64 evaluate(const Validator* validator,bool recursive,bool unhighlight);
+    /**
+     * @brief getValidity
+     * @param value
+     * @return the validator result for one die showing value, evaluate must have been called.
+     */
+    qint64 getValidity(qint64 value) const;
+    /**
+     * @brief hasValidDie
+     * @return true if at least one die is accepted by the evaluated validator.
+     */
+    bool hasValidDie() const;
+    /**
+     * @brief hasInvalidDie
+     * @return true if at least one die is rejected by the evaluated validator.
+     */
+    bool hasInvalidDie() const;
+    /**
+     * @brief applyHighlight sets the highlight of dice as the evaluated validator would have done.
+     * @param diceList dice described by this histogram.
+     */
+    void applyHighlight(const QList<Die*>& diceList) const;
+    /**
+     * @brief applyHighlight sets the highlight of one die as the evaluated validator would have done.
+     * @param die
+     */
+    void applyHighlight(Die* die) const;
+    /**
+     * @brief getValidPart
+     * @return histogram of the dice accepted by the evaluated validator.
+     */
+    DiceHistogram getValidPart() const;
+    /**
+     * @brief getLowest
+     * @param number
+     * @return histogram of the number lowest dice.
+     */
+    DiceHistogram getLowest(quint64 number) const;
+    /**
+     * @brief getHighest
+     * @param number
+     * @return histogram of the number highest dice.
+     */
+    DiceHistogram getHighest(quint64 number) const;
+
+private:
+    int getIndex(qint64 value) const;
+    void computeSum();
+
+private:
+    qint64 m_minValue;
+    QVector<quint64> m_counts;
+    quint64 m_diceCount;
+    qint64 m_sum;
+    bool m_valid;
+    QVector<qint64> m_validity;
+    QVector<bool> m_highlight;
+};
+
+#endif // DICEHISTOGRAM_H
@@ -21,19 +21,35 @@
 ***************************************************************************/
 
 #include "diceresult.h"
+#include "evaluationbudget.h"
+#include "validator.h"
 #include <QDebug>
 
 DiceResult::DiceResult()
-    : m_operator(Die::PLUS)
+    : m_borrowingDice(false),m_histogramBuilt(false),m_operator(Die::PLUS),m_pendingValidator(nullptr)
 {
     m_resultTypes= (DICE_LIST | SCALAR);
     m_homogeneous = true;
 }
 void DiceResult::insertResult(Die* die)
 {
+    applyPendingHighlight();
+    EvaluationBudget* budget = EvaluationBudget::current();
+    if(nullptr!=budget)
+    {
+        budget->addBytes(sizeof(Die));
+    }
     m_diceValues.append(die);
+    m_histogramBuilt = false;
+    invalidateScalar();
 }
 QList<Die*>& DiceResult::getResultList()
+{
+    applyPendingHighlight();
+    invalidateScalar();
+    return m_diceValues;
+}
+const QList<Die*>& DiceResult::getDiceList() const
 {
     return m_diceValues;
 }
@@ -48,46 +64,149 @@ void DiceResult::setHomogeneous(bool b)
 
 void DiceResult::setResultList(QList<Die*> list)
 {
-	qDeleteAll(m_diceValues.begin(), m_diceValues.end());
+    applyPendingHighlight();
+    if(!m_borrowingDice)
+    {
+        qDeleteAll(m_diceValues.begin(), m_diceValues.end());
+    }
+    m_borrowingDice = false;
     m_diceValues.clear();
     m_diceValues << list;
+    m_histogramBuilt = false;
+    invalidateScalar();
 }
-DiceResult::~DiceResult()
+void DiceResult::setBorrowedResultList(QList<Die*> list)
 {
-    if(!m_diceValues.isEmpty())
+    applyPendingHighlight();
+    if(!m_borrowingDice)
     {
         qDeleteAll(m_diceValues.begin(), m_diceValues.end());
-        m_diceValues.clear();
     }
+    EvaluationBudget* budget = EvaluationBudget::current();
+    if(nullptr!=budget)
+    {
+        budget->addBytes(list.size()*sizeof(Die*));
+    }
+    m_borrowingDice = true;
+    m_diceValues = list;
+    m_histogramBuilt = false;
+    invalidateScalar();
 }
-QVariant DiceResult::getResult(RESULT_TYPE type)
+bool DiceResult::isBorrowingDice() const
 {
-    switch (type)
+    return m_borrowingDice;
+}
+DiceHistogram* DiceResult::getHistogram()
+{
+    if(!m_histogramBuilt)
     {
-        case SCALAR:
+        m_histogramBuilt = true;
+        if(m_homogeneous)
+        {
+            m_histogram.build(m_diceValues);
+        }
+        else
         {
-             return getScalarResult();
+            m_histogram = DiceHistogram();
         }
-        case DICE_LIST:
+    }
+    return m_histogram.isValid() ? &m_histogram : nullptr;
+}
+void DiceResult::setHistogram(const DiceHistogram& histogram)
+{
+    m_histogram = histogram;
+    m_histogramBuilt = true;
+}
+void DiceResult::invalidateHistogram()
+{
+    m_histogramBuilt = false;
+    invalidateScalar();
+}
+void DiceResult::setPendingHighlight(const Validator* validator,const DiceHistogram* evaluated)
+{
+    // a previous pending highlight belongs to the dice as they were: it goes first.
+    applyPendingHighlight();
+    m_pendingValidator = validator;
+    m_pendingHistogram = (nullptr!=evaluated) ? *evaluated : DiceHistogram();
+}
+void DiceResult::applyPendingHighlight()
+{
+    if(nullptr==m_pendingValidator)
+    {
+        return;
+    }
+    const Validator* validator = m_pendingValidator;
+    m_pendingValidator = nullptr;
+    if(m_pendingHistogram.isValid())
+    {
+        m_pendingHistogram.applyHighlight(m_diceValues);
+    }
+    else
+    {
+        for(Die* die : m_diceValues)
         {
-            return QVariant();
+            validator->hasValid(die,true,true);
         }
-        default:
-            break;
     }
-    return QVariant();
+    m_pendingHistogram = DiceHistogram();
+}
+void DiceResult::clear()
+{
+    // the highlight was pending on dice which are removed.
+    m_pendingValidator = nullptr;
+    m_pendingHistogram = DiceHistogram();
+    if(!m_borrowingDice)
+    {
+        qDeleteAll(m_diceValues.begin(), m_diceValues.end());
+    }
+    m_borrowingDice = false;
+    m_diceValues.clear();
+    m_histogramBuilt = false;
+    invalidateScalar();
+}
+Result* DiceResult::takeContent()
+{
+    DiceResult* result = new DiceResult();
+    result->m_resultTypes = m_resultTypes;
+    result->setPrevious(getPrevious());
+    result->m_diceValues.swap(m_diceValues);
+    result->m_homogeneous = m_homogeneous;
+    result->m_borrowingDice = m_borrowingDice;
+    result->m_histogram = m_histogram;
+    result->m_histogramBuilt = m_histogramBuilt;
+    result->m_operator = m_operator;
+    result->m_pendingValidator = m_pendingValidator;
+    result->m_pendingHistogram = m_pendingHistogram;
 
+    m_borrowingDice = false;
+    m_histogramBuilt = false;
+    m_pendingValidator = nullptr;
+    m_pendingHistogram = DiceHistogram();
+    invalidateScalar();
+    return result;
+}
+DiceResult::~DiceResult()
+{
+    if((!m_borrowingDice)&&(!m_diceValues.isEmpty()))
+    {
+        qDeleteAll(m_diceValues.begin(), m_diceValues.end());
+        m_diceValues.clear();
+    }
 }
 /*bool DiceResult::hasResultOfType(RESULT_TYPE type) const
 {
     return (m_resultTypes & type);
 }*/
-qreal DiceResult::getScalarResult()
+qreal DiceResult::computeScalar()
 {
     if(m_diceValues.size()==1)
     {
         return m_diceValues[0]->getValue();
     }
+    else if((m_operator==Die::PLUS)&&(m_histogramBuilt)&&(m_histogram.isValid()))
+    {
+        return m_histogram.getSum();
+    }
     else
     {
         qint64 scalar=0;
@@ -139,6 +258,7 @@ Die::ArithmeticOperator DiceResult::getOperator() const
 void DiceResult::setOperator(const Die::ArithmeticOperator& dieOperator)
 {
     m_operator = dieOperator;
+    invalidateScalar();
 }
 QString DiceResult::toString(bool wl)
 {
@@ -149,7 +269,7 @@ QString DiceResult::toString(bool wl)
     }
     if(wl)
     {
-		return QStringLiteral("%3 [label=\"DiceResult Value %1 dice %2\"]").arg(getScalarResult()).arg(scalarSum.join('_')).arg(m_id);
+		return QStringLiteral("%3 [label=\"DiceResult Value %1 dice %2\"]").arg(scalar()).arg(scalarSum.join('_')).arg(m_id);
 	}
 	else
 	{
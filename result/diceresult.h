@@ -25,6 +25,9 @@
 
 #include "die.h"
 #include "result.h"
+#include "dicehistogram.h"
+
+class Validator;
 /**
  * @brief The DiceResult class
  */
@@ -41,10 +44,15 @@ public:
 	virtual ~DiceResult();
 
     /**
-     * @brief getResultList
+     * @brief getResultList gives the dice to change them: the stored scalar is invalidated.
      * @return
      */
     QList<Die*>& getResultList();
+    /**
+     * @brief getDiceList read only access to the dice, see Result::dice().
+     * @return
+     */
+    const QList<Die*>& getDiceList() const;
     /**
      * @brief insertResult
      */
@@ -55,12 +63,53 @@ public:
      * @param list
      */
     void setResultList(QList<Die*> list);
-
     /**
-     * @brief getScalar
-     * @return
+     * @brief setBorrowedResultList sets dice owned by a previous result, they are referenced without any copy.
+     * The result will not delete them. Previous results live as long as the execution tree, so it is safe.
+     * @param list
+     */
+    void setBorrowedResultList(QList<Die*> list);
+    /**
+     * @brief isBorrowingDice
+     * @return true when the dice are owned by a previous result.
+     */
+    bool isBorrowingDice() const;
+    /**
+     * @brief getHistogram builds the histogram of homogeneous dice on first call.
+     * @return the histogram or nullptr when dice are not eligible.
+     */
+    DiceHistogram* getHistogram();
+    /**
+     * @brief setHistogram sets a histogram derived from the previous result, it must describe the dice list.
+     * @param histogram
      */
-    virtual QVariant getResult(RESULT_TYPE);
+    void setHistogram(const DiceHistogram& histogram);
+    /**
+     * @brief invalidateHistogram must be called when dice values are changed, it invalidates the scalar too.
+     */
+    void invalidateHistogram();
+    /**
+     * @brief setPendingHighlight records the highlight a validator gives to the current dice without touching them.
+     * It is applied by applyPendingHighlight(), or before the dice list is changed.
+     * @param validator owned by a node of the tree, it must outlive the result.
+     * @param evaluated optional histogram of the dice evaluated with the validator, read instead of calling it.
+     */
+    void setPendingHighlight(const Validator* validator,const DiceHistogram* evaluated = nullptr);
+    /**
+     * @brief applyPendingHighlight sets the highlight recorded by setPendingHighlight on the dice.
+     * It is called where dice are read for output (ResultSummary, MergeNode) or by the node which
+     * recorded it when other nodes run after it. getDiceList() gives the dice as they are.
+     */
+    void applyPendingHighlight();
+    /**
+     * @brief clear removes the dice, a node calls it before it rolls or copies dice again.
+     */
+    void clear();
+    /**
+     * @brief takeContent gives the dice, borrowed or not, and the pending highlight to the new result.
+     */
+    virtual Result* takeContent();
+
     /**
      * @brief toString
      * @return
@@ -78,12 +127,17 @@ public:
     Die::ArithmeticOperator getOperator() const;
     void setOperator(const Die::ArithmeticOperator & dieOperator);
 
-private:
-    qreal getScalarResult();
+protected:
+    virtual qreal computeScalar();
 private:
     QList<Die*> m_diceValues;
     bool m_homogeneous;
+    bool m_borrowingDice;
+    DiceHistogram m_histogram;
+    bool m_histogramBuilt;
     Die::ArithmeticOperator m_operator;
+    const Validator* m_pendingValidator;
+    DiceHistogram m_pendingHistogram;
 };
 
 #endif // DICERESULT_H
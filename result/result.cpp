@@ -20,10 +20,12 @@
 * 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
 ***************************************************************************/
 #include "result.h"
+#include "diceresult.h"
+#include "stringresult.h"
 #include <QUuid>
 
 Result::Result()
-    : m_resultTypes(NONE),m_id(QString("\"%1\"").arg(QUuid::createUuid().toString())),m_previous(nullptr)
+    : m_resultTypes(NONE),m_id(QString("\"%1\"").arg(QUuid::createUuid().toString())),m_previous(nullptr),m_scalar(0),m_scalarValid(false)
 {
 }
 Result::~Result()
@@ -50,6 +52,45 @@ bool Result::hasResultOfType(RESULT_TYPE type) const
 {
     return (m_resultTypes & type);
 }
+QVariant Result::getResult(RESULT_TYPE type)
+{
+    switch(type)
+    {
+    case SCALAR:
+        return scalar();
+    case STRING:
+        return text();
+    default:
+        break;
+    }
+    return QVariant();
+}
+// only StringResult has the STRING type and only DiceResult the DICE_LIST type: the casts are checked by the type.
+QString Result::text() const
+{
+    if(m_resultTypes & STRING)
+    {
+        return static_cast<const StringResult*>(this)->getText();
+    }
+    return QString();
+}
+const QList<Die*>* Result::dice() const
+{
+    if(m_resultTypes & DICE_LIST)
+    {
+        return &static_cast<const DiceResult*>(this)->getDiceList();
+    }
+    return nullptr;
+}
+qreal Result::computeScalar()
+{
+    return 0;
+}
+void Result::setScalar(qreal value)
+{
+    m_scalar = value;
+    m_scalarValid = true;
+}
 void Result::generateDotTree(QString& s)
 {
 	s.append(toString(true));
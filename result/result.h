@@ -25,6 +25,9 @@
 //#include <Qt>
 #include <QString>
 #include <QVariant>
+#include <QList>
+
+class Die;
 /**
  * @brief The Result class
  */
@@ -50,10 +53,40 @@ public:
      */
     virtual bool hasResultOfType(RESULT_TYPE) const;
     /**
-     * @brief getScalar
+     * @brief getResult boxes the typed accessors in a QVariant, nodes use scalar(), text() and dice() instead.
      * @return
      */
-    virtual QVariant getResult(RESULT_TYPE) = 0;
+    QVariant getResult(RESULT_TYPE);
+    /**
+     * @brief scalar is computed on first call only, until the result changes (see invalidateScalar).
+     * @return the scalar of the result, 0 when it has none.
+     */
+    inline qreal scalar()
+    {
+        if(!m_scalarValid)
+        {
+            m_scalar = computeScalar();
+            m_scalarValid = true;
+        }
+        return m_scalar;
+    }
+    /**
+     * @brief text
+     * @return the text of a string result, empty otherwise.
+     */
+    QString text() const;
+    /**
+     * @brief dice
+     * @return the dice of a dice result, nullptr otherwise.
+     */
+    const QList<Die*>* dice() const;
+    /**
+     * @brief invalidateScalar must be called when the value given by scalar() changes.
+     */
+    inline void invalidateScalar()
+    {
+        m_scalarValid = false;
+    }
     /**
      * @brief getPrevious
      * @return
@@ -83,11 +116,30 @@ public:
      * @return
      */
 	virtual QString toString(bool wl) = 0;
+    /**
+     * @brief takeContent moves the content of this result to a new result of the same type, this one is left empty.
+     * The new result has the same previous result.
+     * @return the new result, owned by the caller.
+     */
+    virtual Result* takeContent() = 0;
+protected:
+    /**
+     * @brief computeScalar is called by scalar() when the stored scalar is not valid.
+     * @return
+     */
+    virtual qreal computeScalar();
+    /**
+     * @brief setScalar stores the scalar of the result, scalar() gives it without computation.
+     * @param value
+     */
+    void setScalar(qreal value);
 protected:
      int m_resultTypes;/// @brief
      QString m_id;
 private:
     Result* m_previous;/// @brief
+    qreal m_scalar;
+    bool m_scalarValid;
 
 };
 
@@ -29,18 +29,23 @@ ScalarResult::ScalarResult()
 
 void ScalarResult::setValue(qreal i)
 {
-    m_value=i;
+    setScalar(i);
 }
-QVariant ScalarResult::getResult(Result::RESULT_TYPE type)
+
+Result* ScalarResult::takeContent()
 {
-    return m_value;
+    ScalarResult* result = new ScalarResult();
+    result->m_resultTypes = m_resultTypes;
+    result->setPrevious(getPrevious());
+    result->setValue(scalar());
+    setValue(0);
+    return result;
 }
-
 QString ScalarResult::toString(bool wl)
 {
 	if(wl)
 	{
-		return QString("%2 [label=\"ScalarResult %1\"]").arg(m_value).arg(m_id);
+		return QString("%2 [label=\"ScalarResult %1\"]").arg(scalar()).arg(m_id);
 	}
 	else
 	{
@@ -35,11 +35,6 @@ public:
      * @brief ScalarResult
      */
     ScalarResult();
-    /**
-     * @brief getResult
-     * @return
-     */
-    virtual QVariant getResult(Result::RESULT_TYPE);
     /**
      * @brief setValue
      * @param i
@@ -50,9 +45,11 @@ public:
      * @return
      */
 	virtual QString toString(bool);
-
-private:
-    qreal m_value;
+    /**
+     * @brief takeContent
+     * @return
+     */
+    virtual Result* takeContent();
 };
 
 #endif // SCALARRESULT_H
@@ -8,6 +8,7 @@ StringResult::StringResult()
 void StringResult::setText(QString text)
 {
     m_value=text;
+    invalidateScalar();
 }
 StringResult::~StringResult()
 {
@@ -32,20 +33,19 @@ QString StringResult::getText() const
 {
     return m_value;
 }
-QVariant StringResult::getResult(RESULT_TYPE type)
+qreal StringResult::computeScalar()
 {
-
-    switch(type)
-    {
-    case STRING:
-        return getText();
-        break;
-    case SCALAR:
-        return getText().toInt();
-        break;
-
-    }
-    return QVariant();
+    return getText().toInt();
+}
+Result* StringResult::takeContent()
+{
+    StringResult* result = new StringResult();
+    result->m_resultTypes = m_resultTypes;
+    result->setPrevious(getPrevious());
+    result->m_value.swap(m_value);
+    result->m_highlight = m_highlight;
+    invalidateScalar();
+    return result;
 }
 QString StringResult::toString(bool wl)
 {
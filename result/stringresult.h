@@ -28,19 +28,21 @@ public:
      */
     QString getText() const;
     /**
-     * @brief getScalar
+     * @brief toString
      * @return
      */
-    virtual QVariant getResult(RESULT_TYPE);
+    virtual QString toString(bool);
     /**
-     * @brief toString
+     * @brief takeContent
      * @return
      */
-    virtual QString toString(bool);
+    virtual Result* takeContent();
 
     virtual void setHighLight(bool );
     virtual bool hasHighLight() const;
     virtual bool hasResultOfType(RESULT_TYPE resultType) const;
+protected:
+    virtual qreal computeScalar();
 private:
     QString m_value;
     bool m_highlight;
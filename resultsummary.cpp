@@ -0,0 +1,204 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include "resultsummary.h"
+
+#include <QSet>
+#include <algorithm>
+
+#include "result/diceresult.h"
+#include "result/stringresult.h"
+
+ResultSummary::ResultSummary()
+    : m_hasScalar(false),m_scalar(0),m_hasDiceList(false),m_diceSum(0),m_hasString(false),m_stringHighlighted(false),m_faceCount(0),m_homogeneous(true)
+{
+
+}
+void ResultSummary::collect(Result* leaf)
+{
+    QSet<Die*> exported;
+    QSet<Die*> known;
+    bool diceSumDone = false;
+    for(Result* result = leaf; nullptr!=result; result = result->getPrevious())
+    {
+        if((!m_hasScalar)&&(result->hasResultOfType(Result::SCALAR)))
+        {
+            m_scalar = result->scalar();
+            m_hasScalar = true;
+        }
+        if(result->hasResultOfType(Result::DICE_LIST))
+        {
+            m_hasDiceList = true;
+            DiceResult* diceResult = dynamic_cast<DiceResult*>(result);
+            if(nullptr!=diceResult)
+            {
+                // the highlight of an if (one-of, all-of) ending the chain is set here, where dice are output.
+                diceResult->applyPendingHighlight();
+                const QList<Die*>& diceList = diceResult->getDiceList();
+                if(!diceSumDone)
+                {
+                    for(Die* die : diceList)
+                    {
+                        m_diceSum += die->getValue();
+                    }
+                    diceSumDone = true;
+                }
+                if(m_homogeneous)
+                {
+                    m_homogeneous = diceResult->isHomogeneous();
+                }
+                int first = m_exportedDice.size();
+                quint64 face=0;
+                for(Die* die : diceList)
+                {
+                    if(!known.contains(die))
+                    {
+                        known.insert(die);
+                        m_allDice << die;
+                    }
+                    // a die already marked by a node, or exported by a later result, is not exported again.
+                    if((!die->hasBeenDisplayed())&&(!exported.contains(die)))
+                    {
+                        exported.insert(die);
+                        face = die->getFaces();
+                        m_exportedDice.append(qMakePair(face,die));
+                    }
+                }
+                // dice of one result are displayed with the faces of its last die.
+                for(int i = first; i < m_exportedDice.size(); ++i)
+                {
+                    m_exportedDice[i].first = face;
+                }
+            }
+        }
+        if(result->hasResultOfType(Result::STRING))
+        {
+            if(!m_hasString)
+            {
+                m_string = result->text();
+                m_hasString = true;
+            }
+            StringResult* stringResult = dynamic_cast<StringResult*>(result);
+            if(nullptr!=stringResult)
+            {
+                m_allStrings << stringResult->getText();
+                m_stringHighlighted = stringResult->hasHighLight();
+            }
+        }
+    }
+    std::stable_sort(m_exportedDice.begin(),m_exportedDice.end(),[](const QPair<quint64,Die*>& a,const QPair<quint64,Die*>& b){
+        return a.first < b.first;
+    });
+    for(int i = 0; i < m_exportedDice.size(); ++i)
+    {
+        if((i==0)||(m_exportedDice[i].first != m_exportedDice[i-1].first))
+        {
+            ++m_faceCount;
+        }
+    }
+}
+bool ResultSummary::hasScalar() const
+{
+    return m_hasScalar;
+}
+qreal ResultSummary::getScalar() const
+{
+    return m_scalar;
+}
+bool ResultSummary::hasDiceList() const
+{
+    return m_hasDiceList;
+}
+qreal ResultSummary::getDiceSum() const
+{
+    return m_diceSum;
+}
+bool ResultSummary::hasString() const
+{
+    return m_hasString;
+}
+QString ResultSummary::getString() const
+{
+    return m_string;
+}
+QStringList ResultSummary::getAllStrings() const
+{
+    return m_allStrings;
+}
+bool ResultSummary::isStringHighlighted() const
+{
+    return m_stringHighlighted;
+}
+void ResultSummary::visitDice(DiceVisitor& visitor) const
+{
+    for(int i = 0; i < m_exportedDice.size(); ++i)
+    {
+        quint64 face = m_exportedDice[i].first;
+        if((i==0)||(face != m_exportedDice[i-1].first))
+        {
+            visitor.beginFace(face,m_faceCount);
+        }
+        Die* die = m_exportedDice[i].second;
+        visitor.visitDie(die->getValue(),die->getListValue(),die->isHighlighted(),die->getColor());
+        if((i+1==m_exportedDice.size())||(face != m_exportedDice[i+1].first))
+        {
+            visitor.endFace(face);
+        }
+    }
+}
+ExportedDiceResult ResultSummary::getExportedDice() const
+{
+    ExportedDiceResult diceValues;
+    for(const QPair<quint64,Die*>& pair : m_exportedDice)
+    {
+        Die* die = pair.second;
+        QList<quint64> valuesResult;
+        valuesResult.append(die->getValue());
+        if(die->hasChildrenValue())
+        {
+            for(qint64 i : die->getListValue())
+            {
+                valuesResult.append(i);
+            }
+        }
+        diceValues[static_cast<int>(pair.first)].append(HighLightDice(valuesResult,die->isHighlighted(),die->getColor()));
+    }
+    return diceValues;
+}
+bool ResultSummary::isHomogeneous() const
+{
+    return m_homogeneous;
+}
+QStringList ResultSummary::getHighlightedDiceValues() const
+{
+    QStringList values;
+    for(Die* die : m_allDice)
+    {
+        if(die->isHighlighted())
+        {
+            for(qint64 value : die->getListValue())
+            {
+                values << QString::number(value);
+            }
+        }
+    }
+    return values;
+}
@@ -0,0 +1,133 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef RESULTSUMMARY_H
+#define RESULTSUMMARY_H
+
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QStringList>
+
+#include "highlightdice.h"
+#include "result/result.h"
+#include "die.h"
+#include "dicevisitor.h"
+
+typedef QList<HighLightDice > ListDiceResult;
+typedef QMap<int,ListDiceResult > ExportedDiceResult;
+
+/**
+ * @brief The ResultSummary class is a flat view of the results of one instruction.
+ *
+ * It is built by a single walk from the leaf result back to the first one, every getter of DiceParser is then served
+ * from it without walking the tree again.
+ */
+class ResultSummary
+{
+public:
+    /**
+     * @brief ResultSummary
+     */
+    ResultSummary();
+    /**
+     * @brief collect walks the results once.
+     * @param leaf result of the last node of the instruction.
+     */
+    void collect(Result* leaf);
+
+    /**
+     * @brief hasScalar
+     * @return true if one result gives a scalar.
+     */
+    bool hasScalar() const;
+    /**
+     * @brief getScalar
+     * @return the scalar of the last result which has one.
+     */
+    qreal getScalar() const;
+    /**
+     * @brief hasDiceList
+     * @return true if one result gives dice.
+     */
+    bool hasDiceList() const;
+    /**
+     * @brief getDiceSum
+     * @return sum of the dice of the last dice result.
+     */
+    qreal getDiceSum() const;
+    /**
+     * @brief hasString
+     * @return true if one result gives a string.
+     */
+    bool hasString() const;
+    /**
+     * @brief getString
+     * @return string of the last string result.
+     */
+    QString getString() const;
+    /**
+     * @brief getAllStrings
+     * @return texts of all string results, from the last one.
+     */
+    QStringList getAllStrings() const;
+    /**
+     * @brief isStringHighlighted
+     * @return highlight of the first string result, false when there is none.
+     */
+    bool isStringHighlighted() const;
+    /**
+     * @brief visitDice streams the dice to display, grouped by faces. Each die is exported once, by the last result which holds it.
+     * @param visitor
+     */
+    void visitDice(DiceVisitor& visitor) const;
+    /**
+     * @brief getExportedDice
+     * @return copy of the dice to display, see visitDice.
+     */
+    ExportedDiceResult getExportedDice() const;
+    /**
+     * @brief isHomogeneous
+     * @return false if one dice result mixes several kinds of dice.
+     */
+    bool isHomogeneous() const;
+    /**
+     * @brief getHighlightedDiceValues
+     * @return values of the highlighted dice of all dice results.
+     */
+    QStringList getHighlightedDiceValues() const;
+
+private:
+    bool m_hasScalar;
+    qreal m_scalar;
+    bool m_hasDiceList;
+    qreal m_diceSum;
+    bool m_hasString;
+    QString m_string;
+    QStringList m_allStrings;
+    bool m_stringHighlighted;
+    QList<QPair<quint64,Die*>> m_exportedDice;
+    int m_faceCount;
+    bool m_homogeneous;
+    QList<Die*> m_allDice;
+};
+
+#endif // RESULTSUMMARY_H
@@ -0,0 +1,232 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include "treesimplifier.h"
+
+#include "node/parenthesesnode.h"
+#include "node/paintnode.h"
+#include "node/startingnode.h"
+#include "node/fusedrollnode.h"
+
+#define MAX_FOLDED_SUM (Q_INT64_C(1)<<62)
+#define MAX_FOLDED_FACTOR (Q_INT64_C(1)<<31)
+#define MAX_FOLDED_DIVIDEND (Q_INT64_C(1)<<53)
+
+TreeSimplifier::TreeSimplifier()
+    : m_removedNodeCount(0),m_fusedCount(0)
+{
+
+}
+ExecutionNode* TreeSimplifier::simplify(ExecutionNode* first)
+{
+    ExecutionNode* previous = nullptr;
+    ExecutionNode* node = first;
+    while(nullptr != node)
+    {
+        ExecutionNode* next = node->getNextNode();
+        ExecutionNode* replacement = node;
+        bool removed = false;
+
+        if(ParenthesesNode* parentheses = dynamic_cast<ParenthesesNode*>(node))
+        {
+            parentheses->setInternelNode(simplify(parentheses->getInternalNode()));
+            NumberNode* number = getSingleNumber(parentheses->getInternalNode());
+            if(nullptr != number)
+            {
+                number->addSourceSpan(parentheses);
+                parentheses->setInternelNode(nullptr);
+                number->setNextNode(next);
+                removeNode(parentheses);
+                replacement = number;
+            }
+        }
+        else if(ScalarOperatorNode* op = dynamic_cast<ScalarOperatorNode*>(node))
+        {
+            op->setInternalNode(simplify(op->getInternalNode()));
+            if(foldOperator(previous,op))
+            {
+                removeNode(op);
+                replacement = next;
+                removed = true;
+            }
+        }
+        else if(PainterNode* painter = dynamic_cast<PainterNode*>(node))
+        {
+            // a painter without previous node stops the chain, it must stay.
+            if((nullptr != previous)&&(!painter->hasColor()))
+            {
+                removeNode(painter);
+                replacement = next;
+                removed = true;
+            }
+        }
+
+        if(replacement != node)
+        {
+            if(nullptr == previous)
+            {
+                first = replacement;
+            }
+            else
+            {
+                previous->setNextNode(replacement);
+            }
+        }
+        if(!removed)
+        {
+            // a folded number may now fold with the operator after it, so the replacement becomes the previous node.
+            previous = replacement;
+        }
+        node = next;
+    }
+    return first;
+}
+ExecutionNode* TreeSimplifier::fuse(ExecutionNode* first)
+{
+    if(StartingNode* start = dynamic_cast<StartingNode*>(first))
+    {
+        start->setNextNode(fuse(start->getNextNode()));
+        return start;
+    }
+    FusedRollNode* fused = FusedRollNode::lower(first);
+    if(nullptr == fused)
+    {
+        return first;
+    }
+    // the fused node replaces the whole chain, which is deleted with the first node. Its errors point to all of it.
+    for(ExecutionNode* node = first; nullptr != node; node = node->getNextNode())
+    {
+        fused->addSourceSpan(node);
+        if(ScalarOperatorNode* op = dynamic_cast<ScalarOperatorNode*>(node))
+        {
+            fused->addSourceSpan(op->getInternalNode());
+        }
+    }
+    delete first;
+    ++m_fusedCount;
+    return fused;
+}
+int TreeSimplifier::getRemovedNodeCount() const
+{
+    return m_removedNodeCount;
+}
+int TreeSimplifier::getFusedCount() const
+{
+    return m_fusedCount;
+}
+bool TreeSimplifier::foldOperator(ExecutionNode* previous,ScalarOperatorNode* op)
+{
+    NumberNode* operand = getSingleNumber(op->getInternalNode());
+    if((nullptr == previous)||(nullptr == operand))
+    {
+        return false;
+    }
+    qint64 value = 0;
+    if(NumberNode* number = dynamic_cast<NumberNode*>(previous))
+    {
+        if(compute(op->getArithmeticOperator(),number->getNumber(),operand->getNumber(),value))
+        {
+            number->setNumber(value);
+            number->addSourceSpan(op);
+            number->addSourceSpan(operand);
+            return true;
+        }
+    }
+    else if(ScalarOperatorNode* previousOp = dynamic_cast<ScalarOperatorNode*>(previous))
+    {
+        NumberNode* previousOperand = getSingleNumber(previousOp->getInternalNode());
+        if(nullptr == previousOperand)
+        {
+            return false;
+        }
+        Die::ArithmeticOperator first = previousOp->getArithmeticOperator();
+        Die::ArithmeticOperator second = op->getArithmeticOperator();
+        // operands are bounded integers, so x+a-b gives the same value as x+(a-b) and x*a*b as x*(a*b).
+        if(((first == Die::PLUS)||(first == Die::MINUS))&&((second == Die::PLUS)||(second == Die::MINUS)))
+        {
+            qint64 a = (first == Die::PLUS) ? previousOperand->getNumber() : -previousOperand->getNumber();
+            if(compute(second,a,operand->getNumber(),value))
+            {
+                previousOp->setArithmeticOperator(value<0 ? Die::MINUS : Die::PLUS);
+                previousOperand->setNumber(value<0 ? -value : value);
+                previousOperand->addSourceSpan(op);
+                previousOperand->addSourceSpan(operand);
+                return true;
+            }
+        }
+        else if((first == Die::MULTIPLICATION)&&(second == Die::MULTIPLICATION))
+        {
+            if(compute(second,previousOperand->getNumber(),operand->getNumber(),value))
+            {
+                previousOperand->setNumber(value);
+                previousOperand->addSourceSpan(op);
+                previousOperand->addSourceSpan(operand);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+bool TreeSimplifier::compute(Die::ArithmeticOperator op,qint64 a,qint64 b,qint64& value)
+{
+    switch(op)
+    {
+    case Die::PLUS:
+    case Die::MINUS:
+        if((qAbs(a)>=MAX_FOLDED_SUM)||(qAbs(b)>=MAX_FOLDED_SUM))
+        {
+            return false;
+        }
+        value = (op == Die::PLUS) ? a+b : a-b;
+        return true;
+    case Die::MULTIPLICATION:
+        if((qAbs(a)>=MAX_FOLDED_FACTOR)||(qAbs(b)>=MAX_FOLDED_FACTOR))
+        {
+            return false;
+        }
+        value = a*b;
+        return true;
+    case Die::DIVIDE:
+        if((b == 0)||(qAbs(a)>=MAX_FOLDED_DIVIDEND)||(a%b != 0))
+        {
+            return false;
+        }
+        value = a/b;
+        return true;
+    default:
+        return false;
+    }
+}
+NumberNode* TreeSimplifier::getSingleNumber(ExecutionNode* node)
+{
+    NumberNode* number = dynamic_cast<NumberNode*>(node);
+    if((nullptr != number)&&(nullptr == number->getNextNode()))
+    {
+        return number;
+    }
+    return nullptr;
+}
+void TreeSimplifier::removeNode(ExecutionNode* node)
+{
+    node->setNextNode(nullptr);
+    delete node;
+    ++m_removedNodeCount;
+}
@@ -0,0 +1,96 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef TREESIMPLIFIER_H
+#define TREESIMPLIFIER_H
+
+#include "node/executionnode.h"
+#include "node/numbernode.h"
+#include "node/scalaroperatornode.h"
+#include "die.h"
+
+/**
+ * @brief The TreeSimplifier class rewrites an execution tree after parsing, so each roll runs as few nodes as possible.
+ *
+ * Only rewrites which keep the results unchanged are done:
+ * - operations between numbers are computed once: 2+4/4 becomes the number 3;
+ * - parentheses around a single number are removed: (4*3)D10 becomes 12D10;
+ * - adjacent additions/subtractions or multiplications by numbers are merged: 1d6+1+2 becomes 1d6+3;
+ * - painter nodes without any color are removed.
+ * Divisions are folded only when they are exact, a division by zero is kept to be reported at run time.
+ * Common whole instructions (NdX, NdX+K, NdXkY, NdXc[cond]) are then lowered to a FusedRollNode by fuse().
+ */
+class TreeSimplifier
+{
+public:
+    /**
+     * @brief TreeSimplifier
+     */
+    TreeSimplifier();
+    /**
+     * @brief simplify rewrites the chain starting at first, removed nodes are deleted.
+     * @param first
+     * @return new first node of the chain.
+     */
+    ExecutionNode* simplify(ExecutionNode* first);
+    /**
+     * @brief fuse replaces a whole instruction by a FusedRollNode when it is supported, see FusedRollNode::lower.
+     * @param first first node of the instruction, a StartingNode or not.
+     * @return new first node of the instruction.
+     */
+    ExecutionNode* fuse(ExecutionNode* first);
+    /**
+     * @brief getRemovedNodeCount
+     * @return number of nodes removed since the creation of the simplifier.
+     */
+    int getRemovedNodeCount() const;
+    /**
+     * @brief getFusedCount
+     * @return number of instructions lowered to a FusedRollNode.
+     */
+    int getFusedCount() const;
+
+private:
+    /**
+     * @brief foldOperator merges the operator into the previous node when both operands are numbers.
+     * @return true if the previous node now gives the result of the operator, which can be removed.
+     */
+    bool foldOperator(ExecutionNode* previous,ScalarOperatorNode* op);
+    /**
+     * @brief compute applies the operator like ScalarOperatorNode does, when the result is an exact integer.
+     */
+    static bool compute(Die::ArithmeticOperator op,qint64 a,qint64 b,qint64& value);
+    /**
+     * @brief getSingleNumber
+     * @return the node if the chain is only one number, nullptr otherwise.
+     */
+    static NumberNode* getSingleNumber(ExecutionNode* node);
+    /**
+     * @brief removeNode deletes one node, not the nodes linked to it.
+     */
+    void removeNode(ExecutionNode* node);
+
+private:
+    int m_removedNodeCount;
+    int m_fusedCount;
+};
+
+#endif // TREESIMPLIFIER_H
@@ -1,14 +1,19 @@
 #include "diceserver.h"
+#include "diceformatter.h"
+#include "dicelog.h"
 #include "qhttp/src/qhttpserver.hpp"
 #include "qhttp/src/qhttpserverrequest.hpp"
 #include "qhttp/src/qhttpserverresponse.hpp"
 #include "qhttp/src/qhttpfwd.hpp"
 #include <QHostAddress>
 #include <QUrl>
+#include <chrono>
 
 DiceServer::DiceServer(int port)
-    : QObject(),m_diceParser(new DiceParser())
+    : QObject(),m_diceParser(new DiceParser()),m_slowCommandTime(qEnvironmentVariableIntValue("DICESERVER_SLOW_MS")*1000000LL)
 {
+    // commands slower than DICESERVER_SLOW_MS are logged with the time of each node.
+    m_diceParser->setProfilingEnabled(m_slowCommandTime > 0);
 
     m_diceParser->setPathToHelp("<span><a href=\"https://github.com/Rolisteam/DiceParser/blob/master/HelpMe.md\">Documentation</a>");
    // using namespace ;
@@ -21,6 +26,13 @@ DiceServer::DiceServer(int port)
 
                // qhttp::THeaderHash hash = req->headers();
                // qDebug() << hash << res->headers() << qhttp::Stringify::toString(req->method()) << qPrintable(req->url().toString()) << req->collectedData().constData();
+                if(req->url().path() == QStringLiteral("/metrics"))
+                {
+                    res->setStatusCode(qhttp::ESTATUS_OK);
+                    res->addHeader("Content-Type", "text/plain; version=0.0.4");
+                    res->end(m_metrics.scrape());
+                    return;
+                }
                 QString getArg = req->url().toString();
                 getArg=getArg.replace("/?","");
                 QStringList args = getArg.split('&');
@@ -36,9 +48,10 @@ DiceServer::DiceServer(int port)
 
                 if(m_hashArgs.contains("cmd"))
                 {
-                    qDebug() << QUrl::fromPercentEncoding(m_hashArgs["cmd"].toLocal8Bit());
-                    QString result = startDiceParsing(QUrl::fromPercentEncoding(m_hashArgs["cmd"].toLocal8Bit()));
-                    qDebug() << result;
+                    QString cmd = QUrl::fromPercentEncoding(m_hashArgs["cmd"].toLocal8Bit());
+                    DICE_DEBUG(SERVER) << cmd;
+                    QString result = startDiceParsing(cmd);
+                    DICE_DEBUG(SERVER) << result;
 
                     res->setStatusCode(qhttp::ESTATUS_OK);
                     res->addHeader("Access-Control-Allow-Origin", "*");
@@ -68,139 +81,56 @@ DiceServer::DiceServer(int port)
 
         });
     if ( !m_server->isListening() ) {
-            qDebug() << "failed to listen";
+            DICE_WARNING(SERVER) << "failed to listen";
 
         }
     else
     {
-        qDebug()<< "Server is On!!";
+        DICE_INFO(SERVER) << "Server is On!!";
     }
 }
 
 DiceServer::~DiceServer()
 {
-    qDebug()<< "destructor";
+    DICE_DEBUG(SERVER) << "destructor";
 }
-QString DiceServer::diceToText(ExportedDiceResult& dice,bool highlight,bool homogeneous)
+QString DiceServer::diceToText()
 {
-    QStringList resultGlobal;
-    foreach(int face, dice.keys())
-    {
-        QStringList result;
-        QStringList currentStreak;
-        QList<QStringList> allStreakList;
-        ListDiceResult diceResult =  dice.value(face);
-        bool previousHighlight=false;
-        QString previousColor;
-        QString patternColor("<span class=\"dice\">");
-        foreach (HighLightDice tmp, diceResult)
-        {
-            if(previousColor != tmp.getColor())
-            {
-                if(!currentStreak.isEmpty())
-                {
-                    QStringList list;
-                    list << patternColor+currentStreak.join(',')+"</span>";
-                    allStreakList.append(list);
-                    currentStreak.clear();
-                }
-                if(tmp.getColor().isEmpty())
-                {
-                    patternColor = QStringLiteral("<span class=\"dice\">");
-                }
-                else
-                {
-                    patternColor = QStringLiteral("<span style=\"color:%1;font-weight:bold\">").arg(tmp.getColor());
-                }
-            }
-            QStringList diceListStr;
-            if((previousHighlight)&&(!tmp.isHighlighted()))
-            {
-                if(!currentStreak.isEmpty())
-                {
-                    QStringList list;
-                    list << patternColor+currentStreak.join(',')+"</span>";
-                    allStreakList.append(list);
-                    currentStreak.clear();
-                }
-
-            }
-            else if((!previousHighlight)&&(tmp.isHighlighted()))
-            {
-                if(!currentStreak.isEmpty())
-                {
-                    QStringList list;
-                    list << currentStreak.join(',');
-                    allStreakList.append(list);
-                    currentStreak.clear();
-                }
-            }
-            previousHighlight = tmp.isHighlighted();
-            previousColor = tmp.getColor();
-            for(int i =0; i < tmp.getResult().size(); ++i)
-            {
-                qint64 dievalue = tmp.getResult()[i];
-                diceListStr << QString::number(dievalue);
-            }
-            if(diceListStr.size()>1)
-            {
-                QString first = diceListStr.takeFirst();
-                first = QString("%1 [%2]").arg(first).arg(diceListStr.join(','));
-                diceListStr.clear();
-                diceListStr << first;
-            }
-            currentStreak << diceListStr.join(' ');
-        }
-
-        if(previousHighlight)
-        {
-            QStringList list;
-            list <<  patternColor+currentStreak.join(',')+"</span>";
-            allStreakList.append(list);
-        }
-        else
-        {
-            if(!currentStreak.isEmpty())
-            {
-                QStringList list;
-                list << currentStreak.join(',');
-                allStreakList.append(list);
-            }
-        }
-        foreach(QStringList a, allStreakList)
-        {
-            result << a;
-        }
-        if(dice.keys().size()>1)
-        {
-            resultGlobal << QString(" d%2:(%1)").arg(result.join(",")).arg(face);
-        }
-        else
-        {
-            resultGlobal << result.join(",");
-        }
-    }
-    return resultGlobal.join("");
+    m_buffer.resize(0);
+    DiceFormatter<HtmlFormat> formatter(m_buffer);
+    formatter.format(*m_diceParser);
+    return QString::fromUtf8(m_buffer);
 }
 
 QString DiceServer::startDiceParsing(QString cmd)
 {
     QString result("");
     bool highlight = true;
-    if(m_diceParser->parseLine(cmd))
+    m_metrics.addRequest();
+    auto start = std::chrono::steady_clock::now();
+    bool parsed = m_diceParser->parseLine(cmd);
+    auto end = std::chrono::steady_clock::now();
+    m_metrics.observe(ServerMetrics::PARSE,std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count());
+    if(parsed)
     {
+            start = end;
             m_diceParser->Start();
-            if(!m_diceParser->getErrorMap().isEmpty())
+            end = std::chrono::steady_clock::now();
+            m_metrics.observe(ServerMetrics::EXECUTE,std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count());
+            m_metrics.addDice(m_diceParser->getBudget()->getDiceCount());
+            start = end;
+            if((m_slowCommandTime > 0)&&(m_diceParser->getProfiler()->getTotalTime() > m_slowCommandTime))
+            {
+                DICE_WARNING(SERVER) << "Slow command:" << cmd << "\n" << QString::fromUtf8(m_diceParser->getProfiler()->toFoldedStacks());
+            }
+            if(m_diceParser->hasExecutionError())
             {
                 result +=  "<span style=\"color: #FF0000\">Error:</span>" + m_diceParser->humanReadableError() + "<br/>";
             }
             else
             {
 
-                ExportedDiceResult list;
-                bool homogeneous = true;
-                m_diceParser->getLastDiceResult(list,homogeneous);
-                QString diceText = diceToText(list,highlight,homogeneous);
+                QString diceText = diceToText();
                 QString scalarText;
                 QString str;
 
@@ -208,7 +138,7 @@ QString DiceServer::startDiceParsing(QString cmd)
                 {
                     scalarText = QString("%1").arg(m_diceParser->getLastIntegerResult());
                 }
-                else if(!list.isEmpty())
+                else if(m_diceParser->hasDiceResult())
                 {
                     scalarText = QString("%1").arg(m_diceParser->getSumOfDiceResult());
                 }
@@ -232,7 +162,14 @@ QString DiceServer::startDiceParsing(QString cmd)
     {
         result += "<span style=\"color: #00FF00\">Error:</span>" + m_diceParser->humanReadableError() + "<br/>";
     }
-
+    if(parsed)
+    {
+        m_metrics.observe(ServerMetrics::FORMAT,std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count());
+    }
+    for(const Diagnostics::Error& error : m_diceParser->getDiagnostics()->getErrors())
+    {
+        m_metrics.addError(error.getCode());
+    }
 
     return result;
 }
@@ -1,6 +1,7 @@
 #include <QObject>
 #include "diceparser.h"
 #include "qhttp/src/qhttpserver.hpp"
+#include "servermetrics.h"
 
 
 class DiceServer : public QObject
@@ -12,8 +13,11 @@ public:
 
 
     QString startDiceParsing(QString cmd);
-    QString diceToText(ExportedDiceResult &dice, bool highlight, bool homogeneous);
+    QString diceToText();
 private:
     DiceParser* m_diceParser;
+    QByteArray m_buffer;
+    qint64 m_slowCommandTime;
+    ServerMetrics m_metrics;
     qhttp::server::QHttpServer* m_server;
 };
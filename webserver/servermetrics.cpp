@@ -0,0 +1,170 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#include "servermetrics.h"
+
+#include <QMutexLocker>
+
+#define ERROR_CODE_COUNT (ExecutionNode::BUDGET_EXCEEDED+1)
+
+namespace
+{
+// upper bounds of the latency buckets, in nanoseconds.
+const qint64 s_bucketBounds[] = {50000LL,100000LL,250000LL,500000LL,1000000LL,2500000LL,5000000LL,10000000LL,
+                                 25000000LL,50000000LL,100000000LL,250000000LL,1000000000LL};
+const int s_bucketCount = sizeof(s_bucketBounds)/sizeof(s_bucketBounds[0]);
+
+const char* s_stageNames[] = {"parse","execute","format"};
+const char* s_errorNames[] = {"NO_DICE_ERROR","DIE_RESULT_EXPECTED","BAD_SYNTAXE","ENDLESS_LOOP_ERROR","DIVIDE_BY_ZERO",
+                              "NOTHING_UNDERSTOOD","NO_DICE_TO_ROLL","TOO_MANY_DICE","BUDGET_EXCEEDED"};
+static_assert(sizeof(s_errorNames)/sizeof(s_errorNames[0]) == ERROR_CODE_COUNT,"one name per DICE_ERROR_CODE");
+
+struct LocalShard
+{
+    const ServerMetrics* owner;
+    void* shard;
+};
+thread_local LocalShard s_local = {nullptr,nullptr};
+}
+
+/**
+ * @brief The ServerMetrics::Shard struct, the counters written by one thread, allocated apart from the others.
+ */
+struct ServerMetrics::Shard
+{
+    QAtomicInteger<qint64> requests;
+    QAtomicInteger<qint64> dice;
+    QAtomicInteger<qint64> errors[ERROR_CODE_COUNT];
+    // one more bucket for +Inf, counts are not cumulative here.
+    QAtomicInteger<qint64> buckets[ServerMetrics::STAGE_COUNT][s_bucketCount+1];
+    QAtomicInteger<qint64> sums[ServerMetrics::STAGE_COUNT];
+};
+
+ServerMetrics::ServerMetrics()
+{
+
+}
+ServerMetrics::~ServerMetrics()
+{
+    qDeleteAll(m_shards);
+    if(s_local.owner == this)
+    {
+        s_local = {nullptr,nullptr};
+    }
+}
+ServerMetrics::Shard* ServerMetrics::localShard()
+{
+    if(s_local.owner == this)
+    {
+        return static_cast<Shard*>(s_local.shard);
+    }
+    Shard* shard = new Shard();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_shards.append(shard);
+    }
+    s_local = {this,shard};
+    return shard;
+}
+void ServerMetrics::addRequest()
+{
+    localShard()->requests.fetchAndAddRelaxed(1);
+}
+void ServerMetrics::observe(ServerMetrics::Stage stage,qint64 nanoseconds)
+{
+    Shard* shard = localShard();
+    int bucket = 0;
+    while((bucket < s_bucketCount)&&(nanoseconds > s_bucketBounds[bucket]))
+    {
+        ++bucket;
+    }
+    shard->buckets[stage][bucket].fetchAndAddRelaxed(1);
+    shard->sums[stage].fetchAndAddRelaxed(nanoseconds);
+}
+void ServerMetrics::addError(ExecutionNode::DICE_ERROR_CODE code)
+{
+    if((code >= 0)&&(code < ERROR_CODE_COUNT))
+    {
+        localShard()->errors[code].fetchAndAddRelaxed(1);
+    }
+}
+void ServerMetrics::addDice(qint64 count)
+{
+    localShard()->dice.fetchAndAddRelaxed(count);
+}
+QByteArray ServerMetrics::scrape()
+{
+    qint64 requests = 0;
+    qint64 dice = 0;
+    qint64 errors[ERROR_CODE_COUNT] = {};
+    qint64 buckets[STAGE_COUNT][s_bucketCount+1] = {};
+    qint64 sums[STAGE_COUNT] = {};
+    {
+        QMutexLocker locker(&m_mutex);
+        for(Shard* shard : m_shards)
+        {
+            requests += shard->requests.loadAcquire();
+            dice += shard->dice.loadAcquire();
+            for(int code = 0; code < ERROR_CODE_COUNT; ++code)
+            {
+                errors[code] += shard->errors[code].loadAcquire();
+            }
+            for(int stage = 0; stage < STAGE_COUNT; ++stage)
+            {
+                for(int bucket = 0; bucket <= s_bucketCount; ++bucket)
+                {
+                    buckets[stage][bucket] += shard->buckets[stage][bucket].loadAcquire();
+                }
+                sums[stage] += shard->sums[stage].loadAcquire();
+            }
+        }
+    }
+
+    QByteArray out;
+    out.append("# HELP diceserver_requests_total Dice commands received.\n");
+    out.append("# TYPE diceserver_requests_total counter\n");
+    out.append("diceserver_requests_total "+QByteArray::number(requests)+"\n");
+    out.append("# HELP diceserver_dice_rolled_total Dice rolled by the commands, rate() gives dice per second.\n");
+    out.append("# TYPE diceserver_dice_rolled_total counter\n");
+    out.append("diceserver_dice_rolled_total "+QByteArray::number(dice)+"\n");
+    out.append("# HELP diceserver_errors_total Errors of the commands by DICE_ERROR_CODE.\n");
+    out.append("# TYPE diceserver_errors_total counter\n");
+    for(int code = 1; code < ERROR_CODE_COUNT; ++code)
+    {
+        out.append("diceserver_errors_total{code=\""+QByteArray(s_errorNames[code])+"\"} "+QByteArray::number(errors[code])+"\n");
+    }
+    out.append("# HELP diceserver_stage_duration_seconds Time spent parsing, executing and formatting the commands.\n");
+    out.append("# TYPE diceserver_stage_duration_seconds histogram\n");
+    for(int stage = 0; stage < STAGE_COUNT; ++stage)
+    {
+        const QByteArray labels = QByteArray("stage=\"")+s_stageNames[stage]+"\"";
+        qint64 cumulative = 0;
+        for(int bucket = 0; bucket <= s_bucketCount; ++bucket)
+        {
+            cumulative += buckets[stage][bucket];
+            QByteArray bound = (bucket < s_bucketCount) ? QByteArray::number(s_bucketBounds[bucket]/1e9,'g',6) : QByteArray("+Inf");
+            out.append("diceserver_stage_duration_seconds_bucket{"+labels+",le=\""+bound+"\"} "+QByteArray::number(cumulative)+"\n");
+        }
+        out.append("diceserver_stage_duration_seconds_sum{"+labels+"} "+QByteArray::number(sums[stage]/1e9,'f',9)+"\n");
+        out.append("diceserver_stage_duration_seconds_count{"+labels+"} "+QByteArray::number(cumulative)+"\n");
+    }
+    return out;
+}
@@ -0,0 +1,87 @@
+/***************************************************************************
+* Copyright (C) 2014 by Renaud Guezennec                                   *
+* http://www.rolisteam.org/contact                      *
+*                                                                          *
+*  This file is part of DiceParser                                         *
+*                                                                          *
+* DiceParser is free software; you can redistribute it and/or modify       *
+* it under the terms of the GNU General Public License as published by     *
+* the Free Software Foundation; either version 2 of the License, or        *
+* (at your option) any later version.                                      *
+*                                                                          *
+* This program is distributed in the hope that it will be useful,          *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             *
+* GNU General Public License for more details.                             *
+*                                                                          *
+* You should have received a copy of the GNU General Public License        *
+* along with this program; if not, write to the                            *
+* Free Software Foundation, Inc.,                                          *
+* 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.                 *
+***************************************************************************/
+#ifndef SERVERMETRICS_H
+#define SERVERMETRICS_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QAtomicInteger>
+
+#include "node/executionnode.h"
+
+/**
+ * @brief The ServerMetrics class counts the requests of DiceServer and writes them in the Prometheus text format.
+ *
+ * Each thread writes to its own shard: recording is a relaxed atomic add on counters no other thread writes,
+ * without lock. The mutex is only taken when a thread records for the first time and on scrape, which sums the shards.
+ */
+class ServerMetrics
+{
+public:
+    /**
+     * @brief The Stage enum, the steps of a request timed apart.
+     */
+    enum Stage {PARSE,EXECUTE,FORMAT,STAGE_COUNT};
+    /**
+     * @brief ServerMetrics
+     */
+    ServerMetrics();
+    ~ServerMetrics();
+
+    /**
+     * @brief addRequest counts a request.
+     */
+    void addRequest();
+    /**
+     * @brief observe adds a duration to the histogram of a stage.
+     * @param stage
+     * @param nanoseconds
+     */
+    void observe(ServerMetrics::Stage stage,qint64 nanoseconds);
+    /**
+     * @brief addError counts an error of the command.
+     * @param code
+     */
+    void addError(ExecutionNode::DICE_ERROR_CODE code);
+    /**
+     * @brief addDice counts the dice rolled by a command.
+     * @param count
+     */
+    void addDice(qint64 count);
+
+    /**
+     * @brief scrape
+     * @return every metric in the Prometheus text exposition format (version 0.0.4).
+     */
+    QByteArray scrape();
+
+private:
+    struct Shard;
+    Shard* localShard();
+
+private:
+    QMutex m_mutex;
+    QList<Shard*> m_shards;
+};
+
+#endif // SERVERMETRICS_H